@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <thread>
+#include "ArithmeticFunctions.h"
+#include "NumberTheory.h"
+#include "Primes.h"
+
+namespace {
+
+const uint64_t MAX_ARGUMENT = MAX_PRIME_TABLE_LIMIT * MAX_PRIME_TABLE_LIMIT;
+
+uint64_t isqrt(uint64_t x) {
+    uint64_t r = (uint64_t) std::sqrt((double) x);
+    while (r * r > x)
+        --r;
+    while ((r + 1) * (r + 1) <= x)
+        ++r;
+    return r;
+}
+
+double_limb_t power(uint64_t p, int k) {
+    double_limb_t result = 1;
+    for (int i = 0; i < k; ++i)
+        result *= p;
+    return result;
+}
+
+// [low, high) into table, rest is scratch space for the unfactored parts
+void sieve_segment(uint64_t low, uint64_t high, unsigned functions, int k, const PrimeTable &primes,
+                   ArithmeticTable &table, std::vector<uint64_t> &rest) {
+    size_t n = high - low;
+    table.low = low;
+    table.high = high;
+    rest.resize(n);
+    std::iota(rest.begin(), rest.end(), low);
+    if (functions & SMALLEST_PRIME_FACTOR)
+        table.smallest_prime_factor.assign(n, 0);
+    if (functions & EULER_PHI)
+        table.Euler_phi.assign(n, 1);
+    if (functions & MOBIUS)
+        table.Mobius.assign(n, 1);
+    if (functions & DIVISOR_COUNT)
+        table.divisor_count.assign(n, 1);
+    if (functions & DIVISOR_SUM)
+        table.divisor_sum.assign(n, 1);
+
+    // p^e exactly divides n, each function is multiplied by its value at p^e
+    for (uint64_t p : primes) {
+        if (p * p >= high)
+            break;
+
+        // exact division by an odd p is a product with p^(-1) mod 2^64, which leaves a multiple of p at most
+        // 2^64 / p, 2 is divided out by a shift
+        double_limb_t p_k = power(p, k);
+        uint64_t inverse = p, quotient_limit = ~(uint64_t) 0 / p;
+        for (int i = 0; i < 5; ++i)
+            inverse *= 2 - p * inverse;
+        for (uint64_t m = (low + p - 1) / p * p; m < high; m += p) {
+            size_t i = m - low;
+            uint64_t r = rest[i], p_e = p;
+            int e = 1;
+            if (p == 2) {
+                e = std::countr_zero(r);
+                r >>= e;
+                p_e <<= e - 1;
+            } else
+                for (r *= inverse; r * inverse <= quotient_limit; r *= inverse) {
+                    p_e *= p;
+                    ++e;
+                }
+            rest[i] = r;
+
+            if ((functions & SMALLEST_PRIME_FACTOR) && table.smallest_prime_factor[i] == 0)
+                table.smallest_prime_factor[i] = p;
+            if (functions & EULER_PHI)
+                table.Euler_phi[i] *= p_e / p * (p - 1);
+            if (functions & MOBIUS)
+                table.Mobius[i] = e > 1 ? 0 : -table.Mobius[i];
+            if (functions & DIVISOR_COUNT)
+                table.divisor_count[i] *= e + 1;
+            if (functions & DIVISOR_SUM) {
+                double_limb_t sum = 1, term = 1;
+                for (int j = 0; j < e; ++j)
+                    sum += term *= p_k;
+                table.divisor_sum[i] *= sum;
+            }
+        }
+    }
+
+    // a part above sqrt(high) left unfactored is a prime
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t q = rest[i];
+        if ((functions & SMALLEST_PRIME_FACTOR) && table.smallest_prime_factor[i] == 0)
+            table.smallest_prime_factor[i] = q;
+        if (q == 1)
+            continue;
+        if (functions & EULER_PHI)
+            table.Euler_phi[i] *= q - 1;
+        if (functions & MOBIUS)
+            table.Mobius[i] = -table.Mobius[i];
+        if (functions & DIVISOR_COUNT)
+            table.divisor_count[i] *= 2;
+        if (functions & DIVISOR_SUM)
+            table.divisor_sum[i] *= 1 + power(q, k);
+    }
+}
+
+// F(x) for a summatory function with F(v) = base(v) - sum F(v / d) over 2 <= d <= v, in the manner of Deleglise and
+// Rivat. small holds F up to s >= sqrt(x), big[i] = F(x / i) is needed for the x / i > y. Its terms F(w) with s < w <= y
+// come from values(low, high, f), which writes f(n) to f[n - low], summed over blocks of SUMMATORY_BLOCK, so memory
+// holds small, one block and the x / y values of big.
+template<class T, class S, class Base, class Values>
+T summatory(uint64_t x, uint64_t y, const std::vector<S> &small, Base base, Values values) {
+    uint64_t s = small.size() - 1;
+    if (x <= s)
+        return small[x];
+
+    uint64_t count = x / (y + 1);
+    std::vector<T> big(count + 1);
+    std::vector<uint64_t> roots(count + 1);
+    for (uint64_t i = 1; i <= count; ++i) {
+        uint64_t v = x / i, r = roots[i] = isqrt(v);
+        T sum = base(v);
+        // the d <= r with v / d <= s
+        for (uint64_t d = std::max<uint64_t>(2, v / (s + 1) + 1); d <= r; ++d)
+            sum -= T(small[v / d]);
+        // the d > r with v / d = q
+        for (uint64_t q = 1; q <= v / (r + 1); ++q) {
+            uint64_t first = std::max(v / (q + 1), r), last = v / q;
+            if (last > first)
+                sum -= T(last - first) * T(small[q]);
+        }
+        big[i] = sum;
+    }
+
+    // the d <= r with s < v / d <= y, block by block
+    std::vector<T> f;
+    T before = small[s];
+    for (uint64_t low = s + 1; low <= y; low += SUMMATORY_BLOCK) {
+        uint64_t high = std::min(y + 1, low + SUMMATORY_BLOCK);
+        f.resize(high - low);
+        values(low, high, f);
+        for (auto &value : f)
+            value = before += value;
+
+        // v / d >= low needs d <= v / low with d >= 2, v / d < high needs v < high r, about x / i < high^2
+        for (uint64_t i = std::max<uint64_t>(1, x / high / high); i <= count && i <= x / (2 * low); ++i) {
+            uint64_t v = x / i;
+            T sum = 0;
+            for (uint64_t d = std::max<uint64_t>(2, v / high + 1), last = std::min(roots[i], v / low); d <= last; ++d)
+                sum += f[v / d - low];
+            big[i] -= sum;
+        }
+    }
+
+    // the d <= r with v / d > y, from the largest i down
+    for (uint64_t i = count; i >= 1; --i)
+        for (uint64_t d = 2; d <= roots[i] && i * d <= count; ++d)
+            big[i] -= big[i * d];
+
+    return big[1];
+}
+
+// the sieve range [1, y] of the summatory functions for x
+uint64_t summatory_sieve_limit(uint64_t x) {
+    if (x > MAX_ARGUMENT) throw "RangeIsTooLarge";
+    uint64_t y = (uint64_t) std::pow((double) x, 2.0 / 3);
+    return std::min(std::max(y, isqrt(x)), x);
+}
+
+}
+
+void sieve_arithmetic_functions(uint64_t low, uint64_t high, unsigned functions,
+                                const std::function<void(const ArithmeticTable &)> &consumer, int k) {
+    if (low == 0) throw "NumberIsNotPositive";
+    if (high > MAX_ARGUMENT + 1) throw "RangeIsTooLarge";
+    if (low >= high)
+        return;
+    if ((functions & DIVISOR_SUM) && (k < 0 || (double) k * std::log2((double) high) + 4 > 128))
+        throw "DivisorSumOverflow";
+
+    auto primes = get_primes(isqrt(high - 1));
+    uint64_t segments = (high - low + ARITHMETIC_SEGMENT - 1) / ARITHMETIC_SEGMENT;
+    unsigned threads = (unsigned) std::min<uint64_t>(get_factorization_threads(), segments);
+    std::atomic<uint64_t> next(0);
+
+    auto worker = [&]() {
+        ArithmeticTable table;
+        std::vector<uint64_t> rest;
+        for (uint64_t s; (s = next++) < segments;) {
+            uint64_t from = low + s * ARITHMETIC_SEGMENT;
+            sieve_segment(from, std::min(high, from + ARITHMETIC_SEGMENT), functions, k, *primes, table, rest);
+            consumer(table);
+        }
+    };
+
+    if (threads <= 1)
+        worker();
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker);
+        for (auto &thread : pool)
+            thread.join();
+    }
+}
+
+ArithmeticTable sieve_arithmetic_functions(uint64_t low, uint64_t high, unsigned functions, int k) {
+    ArithmeticTable result;
+    result.low = low;
+    result.high = std::max(low, high);
+    size_t n = result.high - low;
+    if (functions & SMALLEST_PRIME_FACTOR)
+        result.smallest_prime_factor.resize(n);
+    if (functions & EULER_PHI)
+        result.Euler_phi.resize(n);
+    if (functions & MOBIUS)
+        result.Mobius.resize(n);
+    if (functions & DIVISOR_COUNT)
+        result.divisor_count.resize(n);
+    if (functions & DIVISOR_SUM)
+        result.divisor_sum.resize(n);
+
+    // segments fill disjoint slices
+    sieve_arithmetic_functions(low, high, functions, [&](const ArithmeticTable &segment) {
+        size_t offset = segment.low - low;
+        auto copy = [&](auto &from, auto &to) { std::copy(from.begin(), from.end(), to.begin() + offset); };
+        copy(segment.smallest_prime_factor, result.smallest_prime_factor);
+        copy(segment.Euler_phi, result.Euler_phi);
+        copy(segment.Mobius, result.Mobius);
+        copy(segment.divisor_count, result.divisor_count);
+        copy(segment.divisor_sum, result.divisor_sum);
+    }, k);
+
+    return result;
+}
+
+long long Mertens_function(uint64_t x) {
+    if (x == 0)
+        return 0;
+
+    std::vector<int32_t> small(isqrt(x) + 1);
+    sieve_arithmetic_functions(1, small.size(), MOBIUS, [&](const ArithmeticTable &segment) {
+        std::copy(segment.Mobius.begin(), segment.Mobius.end(), small.begin() + segment.low);
+    });
+    std::partial_sum(small.begin(), small.end(), small.begin());
+
+    auto values = [](uint64_t low, uint64_t high, std::vector<long long> &f) {
+        sieve_arithmetic_functions(low, high, MOBIUS, [&](const ArithmeticTable &segment) {
+            std::copy(segment.Mobius.begin(), segment.Mobius.end(), f.begin() + (segment.low - low));
+        });
+    };
+    return summatory<long long>(x, summatory_sieve_limit(x), small, [](uint64_t) { return 1LL; }, values);
+}
+
+BigInt totient_sum(uint64_t x) {
+    if (x == 0)
+        return 0;
+
+    std::vector<uint64_t> small(isqrt(x) + 1);
+    sieve_arithmetic_functions(1, small.size(), EULER_PHI, [&](const ArithmeticTable &segment) {
+        std::copy(segment.Euler_phi.begin(), segment.Euler_phi.end(), small.begin() + segment.low);
+    });
+    std::partial_sum(small.begin(), small.end(), small.begin());
+
+    auto values = [](uint64_t low, uint64_t high, std::vector<double_limb_t> &f) {
+        sieve_arithmetic_functions(low, high, EULER_PHI, [&](const ArithmeticTable &segment) {
+            std::copy(segment.Euler_phi.begin(), segment.Euler_phi.end(), f.begin() + (segment.low - low));
+        });
+    };
+    double_limb_t sum = summatory<double_limb_t>(x, summatory_sieve_limit(x), small, [](uint64_t v) {
+        return (double_limb_t) v * (v + 1) / 2;
+    }, values);
+    return BigInt(std::vector<limb_t>{(limb_t) sum, (limb_t) (sum >> 64)}, 1);
+}
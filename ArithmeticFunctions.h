@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BigInt.h"
+
+// Arithmetic functions of every n in a range [low, high) with 1 <= low and high <= MAX_PRIME_TABLE_LIMIT^2,
+// requested as a combination of these flags
+enum ArithmeticFunction : unsigned
+{
+	SMALLEST_PRIME_FACTOR = 1,
+	EULER_PHI = 2,
+	MOBIUS = 4,
+	DIVISOR_COUNT = 8, // tau
+	DIVISOR_SUM = 16,  // sigma_k, the sum of d^k over the divisors d
+};
+
+// value of n at index n - low, the arrays of functions that were not requested stay empty
+struct ArithmeticTable
+{
+	uint64_t low = 0, high = 0;
+	std::vector<uint64_t> smallest_prime_factor; // 1 for n = 1
+	std::vector<uint64_t> Euler_phi;
+	std::vector<int8_t> Mobius;
+	std::vector<uint32_t> divisor_count;
+	std::vector<double_limb_t> divisor_sum;
+};
+
+// Numbers are sieved in segments of this many. A segment keeps the unfactored part of every n while the primes up
+// to sqrt(high) are divided out of it, what remains of it after them is one more prime.
+const uint64_t ARITHMETIC_SEGMENT = 1 << 16;
+
+// Segments are sieved over get_factorization_threads() threads and handed to consumer as they are done, on the
+// thread that sieved them and in no particular order, so memory holds one segment per thread. Throws
+// "RangeIsTooLarge", or "DivisorSumOverflow" if k log2(high) does not leave sigma_k(n) room in 128 bits.
+void sieve_arithmetic_functions(uint64_t low, uint64_t high, unsigned functions,
+                                const std::function<void(const ArithmeticTable&)>& consumer, int k = 1);
+
+// the whole range in one table
+ArithmeticTable sieve_arithmetic_functions(uint64_t low, uint64_t high, unsigned functions, int k = 1);
+
+// The values of mu and phi in (sqrt(x), x^(2/3)] are sieved in blocks of this many, which bounds the memory of the
+// summatory functions to this and sqrt(x) values.
+const uint64_t SUMMATORY_BLOCK = 1 << 22;
+
+// Mertens function mu(1) + ... + mu(x) and Phi(x) = phi(1) + ... + phi(x) in about x^(2/3) steps for x up to
+// MAX_PRIME_TABLE_LIMIT^2: the values at x / i above x^(2/3) come from M(v) = 1 - sum M(v / d) and
+// Phi(v) = v (v + 1) / 2 - sum Phi(v / d) over d >= 2, the d with equal quotients taken together. On one core x = 10^12
+// takes seconds, 10^14 a few minutes and 2^52 about half an hour, the sieve runs over get_factorization_threads().
+long long Mertens_function(uint64_t x);
+BigInt totient_sum(uint64_t x);
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include "BatchGCD.h"
+#include "NumberTheory.h"
+#include "Serialization.h"
+
+namespace {
+
+// runs f(i) for i in [0, count), threads take the next index from a shared counter
+void parallel_for(size_t count, const std::function<void(size_t)> &f) {
+    unsigned threads = (unsigned) std::min<size_t>(get_factorization_threads(), count);
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < count;)
+            f(i);
+    };
+
+    if (threads <= 1)
+        worker();
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker);
+        for (auto &thread : pool)
+            thread.join();
+    }
+}
+
+// node j of the next level from nodes 2j and 2j + 1, an odd last node moves up alone
+BigInt parent(const std::function<BigInt(size_t)> &node, size_t count, size_t j) {
+    return 2 * j + 1 < count ? node(2 * j) * node(2 * j + 1) : node(2 * j);
+}
+
+// remainder of a node from the remainder of its parent
+BigInt reduce(const BigInt &parent_remainder, const BigInt &node) {
+    return parent_remainder % (node * node);
+}
+
+// the answer for modulus n from the remainder of the root modulo n^2
+BigInt leaf_gcd(const BigInt &remainder, const BigInt &n) {
+    return gcd(remainder / n, n);
+}
+
+// level files are written in blocks of nodes computed in parallel, so that memory holds one block
+const size_t BLOCK = 4096;
+
+void write_level(const std::string &path, size_t count, const std::function<BigInt(size_t)> &node) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw "CannotOpenFile";
+    BigIntWriter writer(out);
+
+    std::vector<BigInt> block;
+    for (size_t begin = 0; begin < count; begin += BLOCK) {
+        block.assign(std::min(BLOCK, count - begin), BigInt());
+        parallel_for(block.size(), [&](size_t i) { block[i] = node(begin + i); });
+        for (auto &x : block)
+            writer.write(x);
+    }
+}
+
+}
+
+std::vector<BigInt> batch_gcd(std::span<const BigInt> moduli) {
+    if (moduli.empty())
+        return {};
+
+    std::vector<std::vector<BigInt>> tree(1, std::vector<BigInt>(moduli.begin(), moduli.end()));
+    while (tree.back().size() > 1) {
+        auto &level = tree.back();
+        std::vector<BigInt> next((level.size() + 1) / 2);
+        parallel_for(next.size(), [&](size_t j) {
+            next[j] = parent([&](size_t i) -> BigInt { return level[i]; }, level.size(), j);
+        });
+        tree.push_back(std::move(next));
+    }
+
+    std::vector<BigInt> remainders = tree.back();
+    for (size_t depth = tree.size() - 1; depth-- > 0;) {
+        auto &level = tree[depth];
+        std::vector<BigInt> next(level.size());
+        parallel_for(next.size(), [&](size_t j) { next[j] = reduce(remainders[j / 2], level[j]); });
+        remainders = std::move(next);
+        tree.pop_back();
+    }
+
+    parallel_for(moduli.size(), [&](size_t i) { remainders[i] = leaf_gcd(remainders[i], moduli[i]); });
+    return remainders;
+}
+
+void batch_gcd_file(const std::string &input, const std::string &output, const std::string &directory) {
+    namespace fs = std::filesystem;
+    auto product_path = [&](size_t depth) {
+        return depth == 0 ? input : (fs::path(directory) / ("product_" + std::to_string(depth) + ".bin")).string();
+    };
+    auto remainder_path = [&](size_t depth) {
+        return (fs::path(directory) / ("remainder_" + std::to_string(depth) + ".bin")).string();
+    };
+
+    size_t depth = 0, moduli = BigIntArray::map_file(input).size();
+    if (moduli <= 1) {
+        write_level(output, moduli, [](size_t) { return BigInt(1); });
+        return;
+    }
+
+    for (size_t count = moduli; count > 1; count = (count + 1) / 2, ++depth) {
+        BigIntArray level = BigIntArray::map_file(product_path(depth));
+        write_level(product_path(depth + 1), (count + 1) / 2, [&](size_t j) {
+            return parent([&](size_t i) { return level[i].to_BigInt(); }, count, j);
+        });
+    }
+
+    // the root is its own remainder, then each level is reduced by the one above it
+    fs::copy_file(product_path(depth), remainder_path(depth), fs::copy_options::overwrite_existing);
+    for (; depth > 0; --depth) {
+        BigIntArray level = BigIntArray::map_file(product_path(depth - 1));
+        BigIntArray remainders = BigIntArray::map_file(remainder_path(depth));
+        write_level(depth > 1 ? remainder_path(depth - 1) : output, level.size(), [&](size_t j) {
+            BigInt n = level[j].to_BigInt(), r = reduce(remainders[j / 2].to_BigInt(), n);
+            return depth > 1 ? r : leaf_gcd(r, n);
+        });
+
+        fs::remove(remainder_path(depth));
+        fs::remove(product_path(depth));
+    }
+}
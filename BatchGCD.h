@@ -0,0 +1,17 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include "BigMath.h"
+
+// Bernstein's batch gcd: gcd(n_i, product of all other n_j) for every modulus, 1 when it shares no prime with the rest.
+// A product tree multiplies the moduli pairwise up to the root P, a remainder tree reduces P modulo n_i^2 back down,
+// and gcd((P mod n_i^2) / n_i, n_i) is the answer. Quasi-linear instead of k^2 gcds, every tree level is split over
+// get_factorization_threads() threads.
+std::vector<BigInt> batch_gcd(std::span<const BigInt> moduli);
+
+// The same from a file of positive moduli in the binary stream format of Serialization.h to an output file in that
+// format, in input order. Every tree level is written to a file in directory and mapped when read back, so memory
+// holds only a block of nodes at a time besides the largest node. The level files are removed at the end.
+void batch_gcd_file(const std::string& input, const std::string& output, const std::string& directory);
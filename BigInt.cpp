@@ -1,102 +1,81 @@
-#include <math.h>
 #include "BigInt.h"
+#include "Radix.h"
 
 BigInt::BigInt() {
     sign = 0;
-    number_of_digits = 1;
-    digits = std::vector<int>(number_of_digits, 0);
 }
 
 BigInt::BigInt(long long n) {
-    number_of_digits = 0;
+    sign = 0;
 
     if (n != 0) {
-        digits = std::vector<int>(0);
-        digits.reserve(100);
-
-        long long abs_n = std::abs(n);
-        sign = n / abs_n;
-
-        while (abs_n > 0) {
-            number_of_digits++;
-            digits.push_back(abs_n % BigInt::base);
-            abs_n /= BigInt::base;
-        }
-    } else *this = BigInt();
+        sign = n > 0 ? 1 : -1;
+        limb_t abs_n = n > 0 ? (limb_t) n : -(limb_t) n;
+        limbs.push_back(abs_n);
+    }
 }
 
-BigInt::BigInt(std::vector<int> n_digits, int n_sign) : digits(n_digits), sign(n_sign) {
-    if (digits.size() == 0) digits.push_back(0);
-
-    while (digits.back() == 0 && digits.size() > 1)
-        digits.pop_back();
-    number_of_digits = digits.size();
+BigInt::BigInt(std::vector<limb_t> n_limbs, int n_sign) {
+    limbs.assign(n_limbs.begin(), n_limbs.begin() + normalized_size(n_limbs.data(), n_limbs.size()));
 
-    for (int i = 0; i < number_of_digits; ++i)
-        if (digits[i] < 0 || digits[i] > base - 1)
-            throw "Unsuitable format error";
-
-    if (digits.size() == 1 && digits[0] == 0)
+    if (limbs.empty())
         sign = 0;
+    else
+        sign = n_sign < 0 ? -1 : 1;
 }
 
-BigInt::BigInt(std::deque<int> n_digits, int n_sign) : sign(n_sign) {
-    for (auto t : n_digits)
-        digits.push_back(t);
-
-    if (digits.size() == 0) digits.push_back(0);
+BigInt::BigInt(std::span<const limb_t> n_limbs, int n_sign) {
+    limbs.assign(n_limbs.begin(), n_limbs.begin() + normalized_size(n_limbs.data(), n_limbs.size()));
 
-    while (digits.back() == 0 && digits.size() > 1)
-        digits.pop_back();
-    number_of_digits = digits.size();
-
-    for (int i = 0; i < number_of_digits; ++i)
-        if (digits[i] < 0 || digits[i] > base - 1)
-            throw "Unsuitable format error";
-
-    if (digits.size() == 1 && digits[0] == 0)
+    if (limbs.empty())
         sign = 0;
+    else
+        sign = n_sign < 0 ? -1 : 1;
 }
 
-BigInt::BigInt(std::string s) {
-    if (s[0] != '-' && !(s[0] >= '0' && s[0] <= '9'))
+BigInt::BigInt(std::string_view s, int radix) : BigInt() {
+    if (!parse(s, *this, radix))
         throw "Unsuitable format error";
+}
 
-    for (int i = 1; i < s.length(); ++i)
-        if (!(s[i] >= '0' && s[i] <= '9'))
-            throw "Unsuitable format error";
-
-    if (s[0] == '-') {
-        sign = -1;
-        s[0] = '0';
-    } else sign = 1;
-
-    for (int i = s.length() - 1; i >= 0; --i)
-        digits.push_back(s[i] - '0');
+bool BigInt::parse(std::string_view s, BigInt &result, int radix) {
+    bool negative = !s.empty() && s[0] == '-';
+    BigInt magnitude;
+    if (!parse_magnitude(s.substr(negative ? 1 : 0), radix, magnitude))
+        return false;
 
-    BigInt a(digits, sign);
+    result = std::move(magnitude);
+    if (negative)
+        result.negate();
+    return true;
+}
 
-    digits = a.get_digits();
+std::string BigInt::to_string(int radix) const {
+    std::string s;
+    if (sign == -1)
+        s.push_back('-');
+    format_magnitude(*this, radix, s);
+    return s;
 }
 
 int BigInt::get_sign() const {
     return sign;
 }
 
-int BigInt::get_number_of_digits() const {
-    return number_of_digits;
+int BigInt::get_number_of_limbs() const {
+    return limbs.size();
 }
 
-std::vector<int> BigInt::get_digits() const {
-    return digits;
+std::span<const limb_t> BigInt::get_limbs() const {
+    return {limbs.data(), limbs.size()};
+}
+
+BigInt &BigInt::negate() {
+    sign = -sign;
+    return *this;
 }
 
 std::ostream &operator<<(std::ostream &os, const BigInt &a) {
-    if (a.get_sign() == -1)
-        os << '-';
-    auto digits = a.get_digits();
-    for (auto it = digits.rbegin(); it != digits.rend(); ++it)
-        os << *it;
-
-    return os;
-}
\ No newline at end of file
+    auto base = os.flags() & std::ios_base::basefield;
+    return os << a.to_string(base == std::ios_base::hex ? 16 : base == std::ios_base::oct ? 8 : 10);
+}
@@ -2,27 +2,51 @@
 
 #include <iostream>
 #include <vector>
-#include <deque>
+#include <span>
 #include <string>
+#include <string_view>
+#include "LimbVector.h"
 
 class BigInt
 {
-	std::vector<int> digits;
-	int number_of_digits;
+	LimbVector limbs; // magnitude in base 2^64, least significant limb first, no leading zero limbs
 	int sign;
 
-public:
-	static const int base = 10;
+	void add_magnitude(std::span<const limb_t> b, int b_sign);
+	void take_limbs(LimbVector& buffer, int n_sign); // moves a result out of a per-thread buffer, normalizing it
 
+public:
 	BigInt();
 	BigInt(long long);
-	BigInt(std::vector<int>, int);
-	BigInt(std::deque<int>, int);
-	BigInt(std::string);
+	BigInt(std::vector<limb_t>, int);
+	BigInt(std::span<const limb_t>, int);
+	BigInt(std::string_view, int radix = 10); // optional '-' then digits, throws "Unsuitable format error"
+
+	BigInt(const BigInt&) = default;
+	BigInt(BigInt&&) noexcept = default;
+	BigInt& operator=(const BigInt&) = default;
+	BigInt& operator=(BigInt&&) noexcept = default;
 
 	int get_sign() const;
-	int get_number_of_digits() const;
-	std::vector<int> get_digits() const;
+	int get_number_of_limbs() const;
+	std::span<const limb_t> get_limbs() const; // valid until the number is modified
+
+	// in-place operators reuse the existing limb buffer, semantics match the binary operators in BigMath
+	BigInt& operator+=(const BigInt&);
+	BigInt& operator-=(const BigInt&);
+	BigInt& operator*=(const BigInt&);
+	BigInt& operator/=(const BigInt&);
+	BigInt& operator%=(const BigInt&);
+	BigInt& operator<<=(int); // multiplies by 2^shift
+	BigInt& operator>>=(int); // divides by 2^shift rounding toward zero, like operator/
+	BigInt& negate();
+
+	// non-throwing parse for the ingest path, leaves result unchanged and returns false on a malformed string
+	static bool parse(std::string_view s, BigInt& result, int radix = 10);
+	std::string to_string(int radix = 10) const; // radix 2 to 36, lowercase digits
+
+	// stores quotient and remainder of a / b into q and r, either may be null or alias a
+	static void divide(const BigInt& a, const BigInt& b, BigInt* q, BigInt* r);
 };
 
-std::ostream& operator<<(std::ostream&, const BigInt&);
\ No newline at end of file
+std::ostream& operator<<(std::ostream&, const BigInt&);
\ No newline at end of file
@@ -1,30 +1,25 @@
 #include <algorithm>
+#include <cmath>
 #include <utility>
-#include <deque>
-#include <map>
 #include "BigMath.h"
+#include "Multiplication.h"
+#include "Division.h"
+#include "FixedInt.h"
+#include "Instrumentation.h"
+#include "ModContext.h"
 
 bool operator>(const BigInt &a, const BigInt &b) {
-    if (a.get_sign() * b.get_sign() == -1)
-        return a.get_sign() == 1;
+    if (a.get_sign() != b.get_sign())
+        return a.get_sign() > b.get_sign();
 
-    if (a.get_sign() * b.get_sign() == 1) {
-        bool reverse = false;
-        if (a.get_sign() == -1) // a < 0 && b < 0
-            reverse = true;
-
-        auto a_digits = a.get_digits(), b_digits = b.get_digits();
-        if (a_digits.size() != b_digits.size())
-            return (a_digits.size() > b_digits.size()) ^ reverse;
-
-        for (int i = a_digits.size() - 1; i >= 0; --i)
-            if (a_digits[i] != b_digits[i])
-                return (a_digits[i] > b_digits[i]) ^ reverse;
-
-        return false;
-    }
+    auto a_limbs = a.get_limbs(), b_limbs = b.get_limbs();
+    int cmp;
+    if (a_limbs.size() == 1 && b_limbs.size() == 1)
+        cmp = a_limbs[0] > b_limbs[0] ? 1 : a_limbs[0] < b_limbs[0] ? -1 : 0;
+    else
+        cmp = compare_limbs(a_limbs.data(), a_limbs.size(), b_limbs.data(), b_limbs.size());
 
-    return a.get_sign() == 1 || b.get_sign() == -1;
+    return a.get_sign() == 1 ? cmp > 0 : cmp < 0;
 }
 
 bool operator<(const BigInt &a, const BigInt &b) {
@@ -32,7 +27,8 @@ bool operator<(const BigInt &a, const BigInt &b) {
 }
 
 bool operator==(const BigInt &a, const BigInt &b) {
-    return (a.get_sign() == b.get_sign() && a.get_digits() == b.get_digits());
+    auto a_limbs = a.get_limbs(), b_limbs = b.get_limbs();
+    return a.get_sign() == b.get_sign() && std::equal(a_limbs.begin(), a_limbs.end(), b_limbs.begin(), b_limbs.end());
 }
 
 bool operator!=(const BigInt &a, const BigInt &b) {
@@ -40,15 +36,19 @@ bool operator!=(const BigInt &a, const BigInt &b) {
 }
 
 bool operator>=(const BigInt &a, const BigInt &b) {
-    return a > b || a == b;
+    return !(b > a);
 }
 
 bool operator<=(const BigInt &a, const BigInt &b) {
-    return a < b || a == b;
+    return !(a > b);
 }
 
 BigInt operator-(const BigInt &a) {
-    return BigInt(a.get_digits(), -1 * a.get_sign());
+    return BigInt(a).negate();
+}
+
+BigInt operator-(BigInt &&a) {
+    return std::move(a.negate());
 }
 
 BigInt operator+(const BigInt &a) {
@@ -56,234 +56,363 @@ BigInt operator+(const BigInt &a) {
 }
 
 BigInt abs(const BigInt &a) {
-    return BigInt(a.get_digits(), 1);
+    return BigInt(a.get_limbs(), 1);
 }
 
-BigInt add_two_positive_numbers(const BigInt &a, const BigInt &b) {
-    if (a < 0 || b < 0)
-        throw "NumbersAreNotPositive";
-
-    std::vector<int> a_digits(a.get_digits()), b_digits(b.get_digits());
-    int sum_number_of_digits = std::max(a_digits.size(), b_digits.size()) + 1;
-    std::vector<int> sum_digits(sum_number_of_digits);
+// adds signed magnitude b to *this, reusing the limb buffer
+void BigInt::add_magnitude(std::span<const limb_t> b, int b_sign) {
+    if (b_sign == 0)
+        return;
+    if (sign == 0) {
+        limbs.assign(b.begin(), b.end());
+        sign = b_sign;
+        return;
+    }
 
-    for (int i = 0; i < sum_number_of_digits - 1; ++i) {
-        if (i < a_digits.size())
-            sum_digits[i] += a_digits[i];
-        if (i < b_digits.size())
-            sum_digits[i] += b_digits[i];
+    size_t n = limbs.size(), m = b.size();
+    if (n == 1 && m == 1) {
+        // word sized operands, a carry still fits the inline limbs
+        limb_t x = limbs[0], y = b[0];
+        if (sign == b_sign) {
+            limbs[0] = x + y;
+            if (limbs[0] < x)
+                limbs.push_back(1);
+        } else if (x != y) {
+            limbs[0] = x > y ? x - y : y - x;
+            if (x < y)
+                sign = b_sign;
+        } else {
+            limbs.clear();
+            sign = 0;
+        }
+        return;
+    }
 
-        sum_digits[i + 1] = sum_digits[i] / BigInt::base;
-        sum_digits[i] %= BigInt::base;
+    if (sign == b_sign) {
+        limbs.resize(std::max(n, m) + 1);
+        limb_t carry = add_limbs(limbs.data(), limbs.data(), std::max(n, m), b.data(), m);
+        limbs.back() = carry;
+    } else if (compare_limbs(limbs.data(), n, b.data(), m) >= 0) {
+        subtract_limbs(limbs.data(), limbs.data(), n, b.data(), m);
+    } else {
+        // |b| > |*this|, so the result is b - *this with the sign of b
+        limbs.resize(m);
+        subtract_limbs(limbs.data(), b.data(), m, limbs.data(), n);
+        sign = b_sign;
     }
 
-    if (sum_number_of_digits == a_digits.size())
-        sum_digits.back() += a_digits.back();
-    if (sum_number_of_digits == b_digits.size())
-        sum_digits.back() += b_digits.back();
+    limbs.resize(normalized_size(limbs.data(), limbs.size()));
+    if (limbs.empty())
+        sign = 0;
+}
 
-    if (sum_digits.back() >= BigInt::base) {
-        sum_digits.back() %= BigInt::base;
-        sum_digits.push_back(1);
-    }
+BigInt &BigInt::operator+=(const BigInt &b) {
+    if (this == &b)
+        return *this <<= 1;
 
-    return BigInt(sum_digits, 1);
+    add_magnitude(b.get_limbs(), b.sign);
+    return *this;
 }
 
-BigInt subtract_two_positive_numbers(const BigInt &a, const BigInt &b) {
-    if (a < 0 || b < 0)
-        throw "NumbersAreNotPositive";
+BigInt &BigInt::operator-=(const BigInt &b) {
+    if (this == &b)
+        return *this = BigInt();
 
-    std::vector<int> a_digits(a.get_digits()), b_digits(b.get_digits());
-    std::vector<int> sum_digits;
-    int sign = 1;
-    if (a < b) {
-        std::swap(a_digits, b_digits);
-        sign = -1;
-    }
+    add_magnitude(b.get_limbs(), -b.sign);
+    return *this;
+}
 
-    for (int i = 0; i < b_digits.size(); ++i) {
-        if (a_digits[i] < b_digits[i]) {
-            a_digits[i] += BigInt::base;
-            a_digits[i + 1] -= 1;
-        }
+// small results are copied, so that the buffer keeps its heap block, larger ones trade places with the old limbs
+void BigInt::take_limbs(LimbVector &buffer, int n_sign) {
+    size_t n = normalized_size(buffer.data(), buffer.size());
+    if (n <= limbs.capacity()) {
+        limbs.assign(buffer.begin(), buffer.begin() + n);
+    } else {
+        buffer.resize(n);
+        limbs.swap(buffer);
+    }
+    sign = n == 0 ? 0 : n_sign;
+}
 
-        sum_digits.push_back(a_digits[i] - b_digits[i]);
+BigInt &BigInt::operator*=(const BigInt &b) {
+    if (sign == 0 || b.sign == 0) {
+        limbs.clear();
+        sign = 0;
+        return *this;
     }
+    INSTRUMENT_COUNT(MULTIPLICATIONS, std::max(limbs.size(), b.limbs.size()));
+
+    if (limbs.size() == 1 && b.limbs.size() == 1) {
+        double_limb_t p = (double_limb_t) limbs[0] * b.limbs[0];
+        limbs.resize((p >> LIMB_BITS) != 0 ? 2 : 1);
+        limbs[0] = (limb_t) p;
+        if (limbs.size() == 2)
+            limbs[1] = (limb_t) (p >> LIMB_BITS);
+        sign *= b.sign;
+        return *this;
+    }
+
+    // the product is built in a per-thread buffer
+    static thread_local LimbVector product;
 
-    for (int i = b_digits.size(); i < a_digits.size(); ++i)
-        sum_digits.push_back(a_digits[i]);
+    product.resize(limbs.size() + b.limbs.size());
+    if (this == &b)
+        square_limbs(product.data(), limbs.data(), limbs.size());
+    else
+        multiply_limbs(product.data(), limbs.data(), limbs.size(), b.limbs.data(), b.limbs.size());
 
-    return BigInt(sum_digits, sign);
+    take_limbs(product, sign * b.sign);
+    return *this;
 }
 
-BigInt operator+(const BigInt &a, const BigInt &b) {
-    if (a > 0) {
-        if (b > 0)
-            return add_two_positive_numbers(a, b);
-        else
-            return subtract_two_positive_numbers(a, abs(b));
+// stores quotient and remainder of a / b into q and r, either may be null or alias a
+void BigInt::divide(const BigInt &a, const BigInt &b, BigInt *q, BigInt *r) {
+    if (b.sign == 0) throw "DividedByZero";
+    if (q == &b || r == &b) {
+        BigInt b_copy(b);
+        divide(a, b_copy, q, r);
+        return;
+    }
+    INSTRUMENT_COUNT(DIVISIONS, a.limbs.size());
+
+    static thread_local LimbVector quotient, remainder;
+    size_t an = a.limbs.size(), bn = b.limbs.size();
+    if (an < bn) {
+        quotient.clear();
+        remainder.assign(a.limbs.begin(), a.limbs.end());
+    } else if (an == 1) {
+        quotient.resize(1);
+        remainder.resize(1);
+        quotient[0] = a.limbs[0] / b.limbs[0];
+        remainder[0] = a.limbs[0] % b.limbs[0];
     } else {
-        if (b > 0)
-            return subtract_two_positive_numbers(b, abs(a));
-        else
-            return -add_two_positive_numbers(abs(a), abs(b));
+        quotient.resize(an - bn + 1);
+        remainder.resize(bn);
+        divide_limbs(quotient.data(), remainder.data(), a.limbs.data(), an, b.limbs.data(), bn);
     }
+    int a_sign = a.sign, q_sign = a.sign * b.sign;
+
+    if (r != nullptr) {
+        r->take_limbs(remainder, 1);
+
+        if (a_sign != 1 && r->sign != 0) {
+            // the remainder of a negative number is b - r
+            r->sign = -1;
+            r->add_magnitude(b.get_limbs(), b.sign);
+        }
+    }
+
+    if (q != nullptr)
+        q->take_limbs(quotient, q_sign);
+}
+
+BigInt &BigInt::operator/=(const BigInt &b) {
+    divide(*this, b, this, nullptr);
+    return *this;
+}
+
+BigInt &BigInt::operator%=(const BigInt &b) {
+    divide(*this, b, nullptr, this);
+    return *this;
+}
+
+BigInt &BigInt::operator<<=(int shift) {
+    if (shift < 0)
+        return *this >>= -shift;
+    if (sign == 0)
+        return *this;
+
+    size_t limb_shift = shift / LIMB_BITS, n = limbs.size();
+    limbs.resize(n + limb_shift + 1);
+    limbs.back() = shift_left_limbs(limbs.data() + limb_shift, limbs.data(), n, shift % LIMB_BITS);
+    std::fill(limbs.begin(), limbs.begin() + limb_shift, 0);
+
+    limbs.resize(normalized_size(limbs.data(), limbs.size()));
+    return *this;
+}
+
+BigInt &BigInt::operator>>=(int shift) {
+    if (shift < 0)
+        return *this <<= -shift;
+
+    size_t limb_shift = shift / LIMB_BITS;
+    if (limb_shift >= limbs.size())
+        return *this = BigInt();
+
+    size_t n = limbs.size() - limb_shift;
+    shift_right_limbs(limbs.data(), limbs.data() + limb_shift, n, shift % LIMB_BITS);
+    limbs.resize(normalized_size(limbs.data(), n));
+    if (limbs.empty())
+        sign = 0;
+    return *this;
+}
+
+BigInt add_two_positive_numbers(const BigInt &a, const BigInt &b) {
+    if (a < 0 || b < 0)
+        throw "NumbersAreNotPositive";
+
+    BigInt sum(a);
+    return sum += b;
+}
+
+BigInt subtract_two_positive_numbers(const BigInt &a, const BigInt &b) {
+    if (a < 0 || b < 0)
+        throw "NumbersAreNotPositive";
+
+    BigInt diff(a);
+    return diff -= b;
+}
+
+BigInt operator+(const BigInt &a, const BigInt &b) {
+    BigInt sum(a);
+    return sum += b;
+}
+
+BigInt operator+(BigInt &&a, const BigInt &b) {
+    return std::move(a += b);
 }
 
 BigInt operator*(const BigInt &a, const BigInt &b) {
-    int prod_sign = a.get_sign() * b.get_sign();
-    std::vector<int> a_digits(a.get_digits()), b_digits(b.get_digits());
-    int prod_number_of_digits = a_digits.size() + b_digits.size();
-    std::vector<int> prod_digits(prod_number_of_digits);
-
-    for (int i = 0; i < a_digits.size(); ++i)
-        for (int j = 0; j < b_digits.size(); ++j)
-            prod_digits[i + j] += a_digits[i] * b_digits[j];
-
-    for (int i = 0; i < prod_number_of_digits - 1; ++i) {
-        prod_digits[i + 1] += prod_digits[i] / BigInt::base;
-        prod_digits[i] %= BigInt::base;
-    }
+    BigInt prod(a);
+    if (&a == &b)
+        return prod *= prod;
+    return prod *= b;
+}
 
-    return BigInt(prod_digits, prod_sign);
+BigInt operator*(BigInt &&a, const BigInt &b) {
+    return std::move(a *= b);
 }
 
 BigInt operator-(const BigInt &a, const BigInt &b) {
-    return a + (-b);
+    BigInt diff(a);
+    return diff -= b;
 }
 
-BigInt operator/(const BigInt &a, const BigInt &b) {
-    if (b == 0) throw "DividedByZero";
-
-    std::vector<int> a_digits = a.get_digits(), result;
-    std::deque<int> dividend;
-    BigInt divider = abs(b);
-    int p = a_digits.size() - 1;
-    while (p >= 0) {
-        int shift = 0;
-        while (BigInt(dividend, 1) < divider && p >= 0) {
-            dividend.push_front(a_digits[p]);
-            p--;
-            shift++;
-        }
-
-        for (int i = 0; i < shift - 1; ++i)
-            result.push_back(0);
-
-        if (BigInt(dividend, 1) >= divider) {
-            int k = 1;
-            BigInt k_divider = divider;
-            BigInt dividend_tmp(dividend, 1);
-            while (k_divider + divider <= dividend_tmp) {
-                k_divider = k_divider + divider;
-                k++;
-            }
-            result.push_back(k);
-
-            auto vec_dividend = (dividend_tmp - k_divider).get_digits();
-            dividend.clear();
-            for (auto t : vec_dividend)
-                dividend.push_back(t);
-        } else result.push_back(0);
-    }
+BigInt operator-(BigInt &&a, const BigInt &b) {
+    return std::move(a -= b);
+}
 
-    reverse(result.begin(), result.end());
+BigInt operator/(const BigInt &a, const BigInt &b) {
+    BigInt quotient(a);
+    return quotient /= b;
+}
 
-    return BigInt(result, a.get_sign() * b.get_sign());
+BigInt operator/(BigInt &&a, const BigInt &b) {
+    return std::move(a /= b);
 }
 
 BigInt operator%(const BigInt &a, const BigInt &b) {
-    if (b == 0) throw "DividedByZero";
-
-    std::vector<int> a_digits = a.get_digits();
-    std::deque<int> dividend;
-    BigInt divider = abs(b);
-    int p = a_digits.size() - 1;
-    while (p >= 0) {
-        int shift = 0;
-        while (BigInt(dividend, 1) < divider && p >= 0) {
-            dividend.push_front(a_digits[p]);
-            p--;
-            shift++;
-        }
+    BigInt remainder(a);
+    return remainder %= b;
+}
 
-        if (BigInt(dividend, 1) >= divider) {
-            BigInt k_divider = divider;
-            BigInt dividend_tmp(dividend, 1);
-            while (k_divider + divider <= dividend_tmp) {
-                k_divider = k_divider + divider;
-            }
-
-            auto vec_dividend = (dividend_tmp - k_divider).get_digits();
-            dividend.clear();
-            for (auto t : vec_dividend)
-                dividend.push_back(t);
-        }
-    }
+BigInt operator%(BigInt &&a, const BigInt &b) {
+    return std::move(a %= b);
+}
 
-    BigInt remainder = BigInt(dividend, 1);
+BigInt operator<<(const BigInt &a, int shift) {
+    BigInt result(a);
+    return result <<= shift;
+}
 
-    if (a.get_sign() == 1 || remainder == 0)
-        return remainder;
-    else
-        return b - remainder;
+BigInt operator>>(const BigInt &a, int shift) {
+    BigInt result(a);
+    return result >>= shift;
 }
 
 std::pair<BigInt, BigInt> div(const BigInt &a, const BigInt &b) {
-    if (b == 0) throw "DividedByZero";
-
-    std::vector<int> a_digits = a.get_digits(), result;
-    std::deque<int> dividend;
-    BigInt divider = abs(b);
-    int p = a_digits.size() - 1;
-    while (p >= 0) {
-        int shift = 0;
-        while (BigInt(dividend, 1) < divider && p >= 0) {
-            dividend.push_front(a_digits[p]);
-            p--;
-            shift++;
-        }
+    std::pair<BigInt, BigInt> result;
+    BigInt::divide(a, b, &result.first, &result.second);
 
-        if (BigInt(dividend, 1) >= divider) {
-            int k = 1;
-            BigInt k_divider = divider;
-            BigInt dividend_tmp(dividend, 1);
-            while (k_divider + divider <= dividend_tmp) {
-                k_divider = k_divider + divider;
-                k++;
-            }
-            result.push_back(k);
-
-            auto vec_dividend = (dividend_tmp - k_divider).get_digits();
-            dividend.clear();
-            for (auto t : vec_dividend)
-                dividend.push_back(t);
-        } else result.push_back(0);
-    }
-
-    reverse(result.begin(), result.end());
+    return result;
+}
 
-    BigInt remainder = BigInt(dividend, 1);
+BigInt sqrt(const BigInt &a) {
+    if (a < 0) throw "Root of negative number";
+    if (a == 0) return 0;
+
+    auto limbs = a.get_limbs();
+    if (limbs.size() == 1) {
+        // the double estimate is off by at most one
+        limb_t root = (limb_t) std::sqrt((double) limbs[0]);
+        while ((double_limb_t) root * root > limbs[0])
+            --root;
+        while ((double_limb_t) (root + 1) * (root + 1) <= limbs[0])
+            ++root;
+        return BigInt(std::vector<limb_t>{root}, 1);
+    }
 
-    if (a.get_sign() != 1 && remainder != 0)
-        remainder = b - remainder;
+    // Newton's iteration at doubling precision, as in CPython's math.isqrt: after the step for d, x is the root of the
+    // leading 2d + 2 bits of a within one. The last division is the only full-size one, so the cost is O(M(n)).
+    int c = (int) (bit_length(limbs.data(), limbs.size()) - 1) / 2;
+    BigInt x = 1;
+    for (int s = LIMB_BITS - 1 - count_leading_zeros(c), d = 0; s >= 0; --s) {
+        int e = d;
+        d = c >> s;
+        BigInt quotient = (a >> (2 * c - e - d + 1)) / x;
+        x <<= d - e - 1;
+        x += quotient;
+    }
 
-    return std::make_pair(BigInt(result, a.get_sign() * b.get_sign()), remainder);
+    return x * x > a ? x - 1 : x;
 }
 
-BigInt sqrt(const BigInt &a) {
+BigInt root(const BigInt &a, int k) {
+    if (k < 1) throw "RootDegreeIsNotPositive";
     if (a < 0) throw "Root of negative number";
-    BigInt l = 0, r = a + 1;
-    while (r - l > 1) {
-        BigInt m = (r + l) / 2;
-        if (m * m > a)
-            r = m;
-        else
-            l = m;
+    if (k == 1 || a < 2) return a;
+    if (k == 2) return sqrt(a);
+
+    auto limbs = a.get_limbs();
+    size_t bits = bit_length(limbs.data(), limbs.size());
+    if (bits <= (size_t) k)
+        return 1;
+
+    // start from a floating-point estimate of 2^(log2(a) / k) with about 30 correct bits, raised to stay above the
+    // root. Newton's iteration from above then decreases to the floor of the root and stops there.
+    size_t low = bits > 53 ? bits - 53 : 0;
+    double w = (std::log2((double) get_bits(limbs.data(), limbs.size(), low, 53)) + low) / k;
+    int shift = std::max(0, (int) w - 52);
+    BigInt x = BigInt((long long) (std::exp2(w - shift) * (1 + 1e-9)) + 1) << shift;
+
+    BigInt k_big = k, k_minus_one = k - 1;
+    if (big_pow(x, k_big) <= a)
+        x = BigInt(1) << (int) ((bits + k - 1) / k);
+
+    while (true) {
+        BigInt y = (k_minus_one * x + a / big_pow(x, k_minus_one)) / k_big;
+        if (y >= x)
+            return x;
+        x = std::move(y);
     }
+}
+
+bool is_perfect_square(const BigInt &a, BigInt *root) {
+    if (a < 0) return false;
+
+    // squares modulo 64, 63, 65 and 11 from a single remainder, they let through about 1 in 160 non-squares
+    static const limb_t FILTER_MODULUS = 64 * 63 * 65 * 11;
+    static const auto squares = [] {
+        std::vector<std::vector<bool>> tables;
+        for (limb_t m : {64, 63, 65, 11}) {
+            tables.emplace_back(m);
+            for (limb_t i = 0; i < m; ++i)
+                tables.back()[i * i % m] = true;
+        }
+        return tables;
+    }();
+
+    auto limbs = a.get_limbs();
+    limb_t r = modulo_limb(limbs.data(), limbs.size(), FILTER_MODULUS);
+    if (!squares[0][r % 64] || !squares[1][r % 63] || !squares[2][r % 65] || !squares[3][r % 11])
+        return false;
 
-    return l;
+    BigInt s = sqrt(a);
+    if (s * s != a)
+        return false;
+    if (root)
+        *root = std::move(s);
+    return true;
 }
 
 BigInt add_modulo(const BigInt &a, const BigInt &b, const BigInt &mod) {
@@ -303,23 +432,43 @@ BigInt divide_modulo(const BigInt &a, const BigInt &b, const BigInt &mod) {
 }
 
 BigInt big_pow(const BigInt &a, const BigInt &p) {
-    if (p == 0) return 1;
-
-    std::pair<BigInt, BigInt> d = div(p, 2);
-    BigInt b = big_pow(a, d.first);
-    b = b * b;
-    if (d.second == 1)
-        b = b * a;
+    // left to right over the bits of p, multiplying by a is cheap next to squaring the growing result
+    auto bits = p.get_limbs();
+    BigInt b = 1;
+    for (size_t i = bit_length(bits.data(), bits.size()); i-- > 0;) {
+        b *= b;
+        if (get_bits(bits.data(), bits.size(), i, 1))
+            b *= a;
+    }
     return b;
 }
 
 BigInt big_pow_modulo(const BigInt &a, const BigInt &p, const BigInt &m) {
     if (p == 0) return 1;
 
-    std::pair<BigInt, BigInt> d = std::make_pair(p / 2, p % 2); //div(p, 2);
-    BigInt b = big_pow_modulo(a, d.first, m);
-    b = b * b;
-    if (d.second == 1)
-        b = b * a;
-    return b % m;
+    if (m > 0)
+        return with_modular_context(m, [&](const auto &context) {
+            return context.pow(context.convert(a), p).to_BigInt();
+        });
+
+    // nonpositive moduli keep the semantics of operator%
+    auto bits = p.get_limbs();
+    BigInt b = 1;
+    for (size_t i = bit_length(bits.data(), bits.size()); i-- > 0;) {
+        b *= b;
+        if (get_bits(bits.data(), bits.size(), i, 1))
+            b *= a;
+        b %= m;
+    }
+    return b;
+}
+
+BigInt big_pow_modulo_constant_time(const BigInt &a, const BigInt &p, const BigInt &m) {
+    ModContext context(m);
+    return context.pow_constant_time(context.convert(a), p).to_BigInt();
+}
+
+BigInt big_multi_pow_modulo(const BigInt &a, const BigInt &x, const BigInt &b, const BigInt &y, const BigInt &m) {
+    ModContext context(m);
+    return context.multi_pow(context.convert(a), x, context.convert(b), y).to_BigInt();
 }
@@ -10,6 +10,7 @@ bool operator>= (const BigInt&, const BigInt&);
 bool operator<= (const BigInt&, const BigInt&);
 
 BigInt operator- (const BigInt&);
+BigInt operator- (BigInt&&);
 BigInt operator+ (const BigInt&);
 BigInt abs(const BigInt&);
 
@@ -22,12 +23,25 @@ BigInt operator* (const BigInt&, const BigInt&);
 BigInt operator- (const BigInt&, const BigInt&);
 BigInt operator/ (const BigInt&, const BigInt&);
 BigInt operator% (const BigInt&, const BigInt&);
+BigInt operator<< (const BigInt&, int);
+BigInt operator>> (const BigInt&, int);
+
+// overloads for temporaries reuse the buffer of the left operand
+BigInt operator+ (BigInt&&, const BigInt&);
+BigInt operator* (BigInt&&, const BigInt&);
+BigInt operator- (BigInt&&, const BigInt&);
+BigInt operator/ (BigInt&&, const BigInt&);
+BigInt operator% (BigInt&&, const BigInt&);
 
 std::pair<BigInt, BigInt> div(const BigInt&, const BigInt&); //returns result of division and reminder
-BigInt sqrt(const BigInt&);
+BigInt sqrt(const BigInt&); // floor of the square root
+BigInt root(const BigInt& a, int k); // floor of the k-th root, k >= 1
+bool is_perfect_square(const BigInt& a, BigInt* root = nullptr); // stores the root if a is a square
 BigInt add_modulo(const BigInt& a, const BigInt& b, const BigInt& mod);
 BigInt subtract_modulo(const BigInt& a, const BigInt& b, const BigInt& mod);
 BigInt multiply_modulo(const BigInt& a, const BigInt& b, const BigInt& mod);
 BigInt divide_modulo(const BigInt& a, const BigInt& b, const BigInt& mod);
 BigInt big_pow(const BigInt& a, const BigInt& p);
-BigInt big_pow_modulo(const BigInt&, const BigInt&, const BigInt&);
\ No newline at end of file
+BigInt big_pow_modulo(const BigInt&, const BigInt&, const BigInt&);
+BigInt big_pow_modulo_constant_time(const BigInt& a, const BigInt& p, const BigInt& m); // Montgomery ladder for secret p, m odd and positive
+BigInt big_multi_pow_modulo(const BigInt& a, const BigInt& x, const BigInt& b, const BigInt& y, const BigInt& m); // a^x * b^y mod m, m > 0
\ No newline at end of file
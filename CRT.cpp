@@ -0,0 +1,167 @@
+#include <utility>
+#include "CRT.h"
+#include "NumberTheory.h"
+
+namespace {
+
+// a mod m in [0, m)
+BigInt residue(const BigInt &a, const BigInt &m) {
+    BigInt r = a % m;
+    if (r < 0)
+        r += m;
+    return r;
+}
+
+void check_moduli(const std::vector<BigInt> &moduli) {
+    for (auto &m : moduli)
+        if (m < 1) throw "ModulusIsNotPositive";
+}
+
+// x = a (mod m) and x = b (mod n) as one congruence x = a (mod lcm(m, n)), a and b are already reduced
+void merge(BigInt &a, BigInt &m, const BigInt &b, const BigInt &n) {
+    BigInt u, v, g = extended_gcd(m, n, u, v);
+    BigInt difference = b - a;
+    if (difference % g != 0) throw "CongruencesAreInconsistent";
+
+    // m u = g (mod n), so a + m u (b - a) / g is the solution, the step is taken modulo n / g to stay below the lcm
+    BigInt step = n / g;
+    a += m * residue(u * (difference / g), step);
+    m *= step;
+}
+
+}
+
+CRTBasis::CRTBasis(const std::vector<BigInt> &moduli) {
+    if (!build(moduli)) throw "ModuliAreNotCoprime";
+}
+
+bool CRTBasis::build(const std::vector<BigInt> &moduli) {
+    check_moduli(moduli);
+    tree.assign(1, moduli);
+    if (moduli.empty())
+        return true;
+
+    while (tree.back().size() > 1) {
+        auto &level = tree.back();
+        std::vector<BigInt> next;
+        next.reserve((level.size() + 1) / 2);
+        for (size_t i = 0; i < level.size(); i += 2)
+            next.push_back(i + 1 < level.size() ? level[i] * level[i + 1] : level[i]);
+        tree.push_back(std::move(next));
+    }
+
+    // remainder tree: M mod (node)^2 down to the leaves, where (M mod m_i^2) / m_i = (M / m_i) mod m_i
+    std::vector<BigInt> remainders = tree.back();
+    for (size_t depth = tree.size() - 1; depth-- > 0;) {
+        auto &level = tree[depth];
+        std::vector<BigInt> next(level.size());
+        for (size_t j = 0; j < level.size(); ++j)
+            next[j] = remainders[j / 2] % (level[j] * level[j]);
+        remainders = std::move(next);
+    }
+
+    inverses.resize(moduli.size());
+    for (size_t i = 0; i < moduli.size(); ++i) {
+        BigInt y;
+        if (extended_gcd(remainders[i] / moduli[i], moduli[i], inverses[i], y) != 1)
+            return false;
+        inverses[i] = residue(inverses[i], moduli[i]);
+    }
+
+    if (moduli.size() <= GARNER_MODULI) {
+        garner.assign(moduli.size(), BigInt(0));
+        for (size_t i = 1; i < moduli.size(); ++i) {
+            BigInt prefix = 1;
+            for (size_t j = 0; j < i; ++j)
+                prefix = prefix * moduli[j] % moduli[i];
+            garner[i] = inverse_modulo(prefix, moduli[i]);
+        }
+    }
+
+    return true;
+}
+
+const std::vector<BigInt> &CRTBasis::get_moduli() const {
+    return tree.front();
+}
+
+const BigInt &CRTBasis::get_modulus() const {
+    static const BigInt one = 1;
+    return tree.front().empty() ? one : tree.back().front();
+}
+
+BigInt CRTBasis::solve(const std::vector<BigInt> &residues) const {
+    if (residues.size() != get_moduli().size()) throw "ResiduesDoNotMatchModuli";
+    if (residues.empty())
+        return 0;
+    return garner.empty() ? solve_tree(residues) : solve_Garner(residues);
+}
+
+// x = sum of r_i (M / m_i)^(-1) M / m_i, summed up the tree: a node gets left * product(right) + right * product(left)
+BigInt CRTBasis::solve_tree(const std::vector<BigInt> &residues) const {
+    auto &moduli = tree.front();
+    std::vector<BigInt> values(moduli.size());
+    for (size_t i = 0; i < moduli.size(); ++i)
+        values[i] = residue(residues[i], moduli[i]) * inverses[i] % moduli[i];
+
+    for (size_t depth = 0; depth + 1 < tree.size(); ++depth) {
+        auto &level = tree[depth];
+        std::vector<BigInt> next((values.size() + 1) / 2);
+        for (size_t j = 0; j < next.size(); ++j)
+            next[j] = 2 * j + 1 < values.size()
+                ? values[2 * j] * level[2 * j + 1] + values[2 * j + 1] * level[2 * j]
+                : std::move(values[2 * j]);
+        values = std::move(next);
+    }
+
+    return values[0] % get_modulus();
+}
+
+// mixed radix digits x = d_0 + d_1 m_0 + d_2 m_0 m_1 + ..., each from the previous ones reduced modulo m_i
+BigInt CRTBasis::solve_Garner(const std::vector<BigInt> &residues) const {
+    auto &moduli = tree.front();
+    std::vector<BigInt> digits(moduli.size());
+    digits[0] = residue(residues[0], moduli[0]);
+    for (size_t i = 1; i < moduli.size(); ++i) {
+        BigInt x = digits[i - 1];
+        for (size_t j = i - 1; j-- > 0;)
+            x = (x * moduli[j] + digits[j]) % moduli[i];
+        digits[i] = residue((residues[i] - x) * garner[i], moduli[i]);
+    }
+
+    BigInt x = digits.back();
+    for (size_t j = moduli.size() - 1; j-- > 0;)
+        x = x * moduli[j] + digits[j];
+    return x;
+}
+
+BigInt solve_congruences(const std::vector<BigInt> &residues, const std::vector<BigInt> &moduli, BigInt *modulus) {
+    if (residues.size() != moduli.size()) throw "ResiduesDoNotMatchModuli";
+
+    CRTBasis basis;
+    if (basis.build(moduli)) {
+        if (modulus)
+            *modulus = basis.get_modulus();
+        return basis.solve(residues);
+    }
+
+    // balanced merging keeps the operands of each extended gcd about the same size
+    std::vector<std::pair<BigInt, BigInt>> congruences;
+    for (size_t i = 0; i < moduli.size(); ++i)
+        congruences.emplace_back(residue(residues[i], moduli[i]), moduli[i]);
+
+    while (congruences.size() > 1) {
+        std::vector<std::pair<BigInt, BigInt>> next;
+        for (size_t i = 0; i < congruences.size(); i += 2) {
+            if (i + 1 < congruences.size())
+                merge(congruences[i].first, congruences[i].second, congruences[i + 1].first,
+                      congruences[i + 1].second);
+            next.push_back(std::move(congruences[i]));
+        }
+        congruences = std::move(next);
+    }
+
+    if (modulus)
+        *modulus = congruences[0].second;
+    return congruences[0].first;
+}
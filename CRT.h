@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include "BigMath.h"
+
+// Precomputation for the Chinese remainder theorem over a fixed set of pairwise coprime positive moduli, for solving
+// many residue vectors against the same moduli. A subproduct tree of the moduli gives every (M / m_i)^(-1) mod m_i
+// from one remainder tree, and a solution is then assembled up the tree in quasi-linear time. Up to GARNER_MODULI
+// moduli Garner's mixed-radix constants are kept as well and used instead, they avoid the products of the tree.
+// A basis is immutable after construction, so it can be shared between threads.
+class CRTBasis
+{
+	std::vector<std::vector<BigInt>> tree; // tree[0] are the moduli, every level multiplies pairs of the one below
+	std::vector<BigInt> inverses;          // (M / m_i)^(-1) mod m_i
+	std::vector<BigInt> garner;            // (m_0 ... m_{i-1})^(-1) mod m_i, empty above GARNER_MODULI moduli
+
+	friend BigInt solve_congruences(const std::vector<BigInt>&, const std::vector<BigInt>&, BigInt*);
+
+	CRTBasis() = default;
+	bool build(const std::vector<BigInt>& moduli); // false if the moduli are not pairwise coprime
+
+	BigInt solve_tree(const std::vector<BigInt>& residues) const;
+	BigInt solve_Garner(const std::vector<BigInt>& residues) const;
+
+public:
+	static const size_t GARNER_MODULI = 4;
+
+	explicit CRTBasis(const std::vector<BigInt>& moduli); // throws "ModuliAreNotCoprime"
+
+	const std::vector<BigInt>& get_moduli() const;
+	const BigInt& get_modulus() const; // product of the moduli
+
+	// the x in [0, M) with x = residues[i] (mod m_i), residues may be any integers
+	BigInt solve(const std::vector<BigInt>& residues) const;
+};
+
+// The x in [0, L) with x = residues[i] (mod moduli[i]) for any positive moduli, L being their lcm, which is stored to
+// modulus if it is given. Pairwise coprime moduli go through a CRTBasis, others are merged pairwise in a balanced tree.
+// Throws "CongruencesAreInconsistent" if there is no solution.
+BigInt solve_congruences(const std::vector<BigInt>& residues, const std::vector<BigInt>& moduli,
+                         BigInt* modulus = nullptr);
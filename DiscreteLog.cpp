@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include "CRT.h"
+#include "DiscreteLog.h"
+#include "NumberTheory.h"
+
+namespace {
+
+// number of precomputed multipliers of the rho walk and jumps of the kangaroos
+const int PARTITIONS = 32;
+
+// open addressing with linear probing from residue hashes to baby step indices, a hash may be stored several times
+class StepTable {
+    std::vector<std::pair<uint64_t, uint64_t>> slots; // indices are stored plus one, 0 marks an empty slot
+    size_t mask;
+
+public:
+    explicit StepTable(size_t n) : slots(std::bit_ceil(2 * n)), mask(slots.size() - 1) {}
+
+    void insert(uint64_t hash, uint64_t index) {
+        size_t i = hash & mask;
+        while (slots[i].second != 0)
+            i = (i + 1) & mask;
+        slots[i] = {hash, index + 1};
+    }
+
+    // f(index) for every index stored under hash
+    template<class F>
+    void find(uint64_t hash, F f) const {
+        for (size_t i = hash & mask; slots[i].second != 0; i = (i + 1) & mask)
+            if (slots[i].first == hash)
+                f(slots[i].second - 1);
+    }
+};
+
+size_t bits_of(const BigInt &a) {
+    auto limbs = a.get_limbs();
+    return bit_length(limbs.data(), limbs.size());
+}
+
+BigInt residue(const BigInt &a, const BigInt &m) {
+    BigInt r = a % m;
+    if (r < 0)
+        r += m;
+    return r;
+}
+
+BigInt random_below(std::mt19937_64 &rng, const BigInt &n) {
+    std::vector<limb_t> limbs(n.get_number_of_limbs() + 1);
+    for (auto &x : limbs)
+        x = rng();
+    return BigInt(limbs, 1) % n;
+}
+
+ModInt inverse(const ModInt &a) {
+    auto &context = a.get_context();
+    return ModInt(context, inverse_modulo(a.to_BigInt(), context.get_modulus()));
+}
+
+// x = x + y mod q for reduced x and y
+void add_reduced(BigInt &x, const BigInt &y, const BigInt &q) {
+    x += y;
+    if (x >= q)
+        x -= q;
+}
+
+void run_workers(unsigned threads, const std::function<void(unsigned)> &worker) {
+    if (threads <= 1)
+        worker(0);
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker, i);
+        for (auto &thread : pool)
+            thread.join();
+    }
+}
+
+// low bits of a hash that must be zero for a distinguished point, so that a thread meets one about every
+// 2^bits steps while the table stays at a few thousand points per thread for walks of the given expected length
+int distinguished_bits(const BigInt &expected_steps, unsigned threads) {
+    return std::clamp((int) bits_of(expected_steps) - 12 - (int) std::bit_width(threads), 0, 32);
+}
+
+}
+
+BigInt discrete_logarithm_BSGS(const ModInt &g, const ModInt &h, const BigInt &bound) {
+    if (bound < 1)
+        return -1;
+
+    auto &context = g.get_context();
+    ModInt one = context.get_one();
+    BigInt steps = sqrt(bound - 1) + 1;
+    size_t baby = steps > BigInt((long long) BSGS_BABY_STEPS) ? BSGS_BABY_STEPS : (size_t) steps.get_limbs()[0];
+
+    // baby steps g^j, a power equal to 1 means that they already run through every power of g
+    StepTable table(baby);
+    ModInt power = one;
+    bool whole_group = false;
+    for (size_t j = 0; j < baby; ++j) {
+        if (j > 0 && power == one) {
+            baby = j;
+            whole_group = true;
+            break;
+        }
+        table.insert(power.hash(), j);
+        power *= g;
+    }
+
+    // giant steps h g^(-baby i), candidates are checked since different residues can share a hash
+    BigInt giant_count = whole_group ? BigInt(1) : (bound + BigInt((long long) baby - 1)) / BigInt((long long) baby);
+    ModInt factor = inverse(power), y = h;
+    for (BigInt i = 0; i < giant_count; i += 1) {
+        long long found = -1;
+        table.find(y.hash(), [&](uint64_t j) {
+            if ((found < 0 || (long long) j < found) && context.pow(g, BigInt((long long) j)) == y)
+                found = (long long) j;
+        });
+        if (found >= 0) {
+            BigInt x = i * BigInt((long long) baby) + BigInt(found);
+            return x < bound ? x : BigInt(-1);
+        }
+        y *= factor;
+    }
+
+    return -1;
+}
+
+BigInt discrete_logarithm_rho(const ModInt &g, const ModInt &h, const BigInt &q) {
+    auto &context = g.get_context();
+    if (context.pow(h, q) != context.get_one())
+        return -1;
+    if (sqrt(q) < BigInt((long long) BSGS_BABY_STEPS))
+        return discrete_logarithm_BSGS(g, h, q);
+
+    // r-adding walk: x -> x g^a_k h^b_k with k from the hash of x, every point is g^a h^b with known a and b
+    std::mt19937_64 rng(q.get_limbs()[0]);
+    std::vector<ModInt> multipliers;
+    std::vector<BigInt> a_steps, b_steps;
+    for (int k = 0; k < PARTITIONS; ++k) {
+        a_steps.push_back(random_below(rng, q));
+        b_steps.push_back(random_below(rng, q));
+        multipliers.push_back(context.multi_pow(g, a_steps.back(), h, b_steps.back()));
+    }
+
+    unsigned threads = get_factorization_threads();
+    BigInt expected_steps = sqrt(q);
+    uint64_t mask = (1ULL << distinguished_bits(expected_steps, threads)) - 1;
+    // a walk caught in a cycle without distinguished points is abandoned after 20 times their mean distance
+    uint64_t walk_limit = 20 * (mask + 1);
+
+    std::atomic<bool> stop(false);
+    std::mutex points_mutex;
+    std::unordered_map<uint64_t, std::pair<BigInt, BigInt>> points;
+    BigInt result = -1;
+
+    run_workers(threads, [&](unsigned index) {
+        std::mt19937_64 rng(123 + index);
+        while (!stop.load(std::memory_order_relaxed)) {
+            BigInt a = random_below(rng, q), b = random_below(rng, q);
+            ModInt x = context.multi_pow(g, a, h, b);
+            for (uint64_t step = 0; step < walk_limit && !stop.load(std::memory_order_relaxed); ++step) {
+                uint64_t hash = x.hash();
+                if ((hash & mask) == 0) {
+                    std::lock_guard<std::mutex> lock(points_mutex);
+                    auto [it, inserted] = points.try_emplace(hash, a, b);
+                    if (!inserted) {
+                        // g^a h^b = g^a' h^b' gives x = (a' - a) / (b - b') unless b = b'
+                        auto &[a_other, b_other] = it->second;
+                        if (b == b_other)
+                            break;
+                        BigInt candidate = residue((a_other - a) * inverse_modulo(residue(b - b_other, q), q), q);
+                        if (context.pow(g, candidate) == h && !stop.exchange(true))
+                            result = candidate;
+                        break;
+                    }
+                }
+
+                int k = (int) ((hash >> 32) % PARTITIONS);
+                x *= multipliers[k];
+                add_reduced(a, a_steps[k], q);
+                add_reduced(b, b_steps[k], q);
+            }
+        }
+    });
+
+    return result;
+}
+
+BigInt discrete_logarithm_kangaroo(const ModInt &g, const ModInt &h, const BigInt &lower, const BigInt &upper) {
+    if (upper < lower)
+        return -1;
+
+    // y = x - lower in [0, width] with g^y = target
+    auto &context = g.get_context();
+    BigInt width = upper - lower;
+    ModInt target = h * context.pow(lower < 0 ? g : inverse(g), lower);
+    if (sqrt(width) < BigInt((long long) BSGS_BABY_STEPS)) {
+        BigInt y = discrete_logarithm_BSGS(g, target, width + 1);
+        return y < 0 ? y : y + lower;
+    }
+
+    // van Oorschot and Wiener: with 2 t kangaroos the mean jump is t sqrt(width) / 2
+    unsigned threads = get_factorization_threads();
+    BigInt mean = sqrt(width) * BigInt((long long) threads) / 2;
+    std::mt19937_64 rng(width.get_limbs()[0]);
+    std::vector<ModInt> jumps;
+    std::vector<BigInt> jump_lengths;
+    for (int k = 0; k < PARTITIONS; ++k) {
+        jump_lengths.push_back(random_below(rng, 2 * mean) + 1);
+        jumps.push_back(context.pow(g, jump_lengths.back()));
+    }
+
+    BigInt expected_steps = 2 * sqrt(width) / BigInt((long long) threads);
+    uint64_t mask = (1ULL << distinguished_bits(expected_steps, threads)) - 1;
+    BigInt step_limit = 16 * expected_steps + BigInt((long long) (64 * (mask + 1)));
+
+    struct Kangaroo {
+        bool tame;
+        ModInt position;
+        BigInt distance; // exponent of position for a tame one, of position / target for a wild one
+    };
+
+    std::atomic<bool> stop(false);
+    std::mutex points_mutex;
+    std::unordered_map<uint64_t, std::pair<bool, BigInt>> points;
+    BigInt result = -1;
+
+    run_workers(threads, [&](unsigned index) {
+        std::mt19937_64 rng(123 + index);
+        // tame kangaroos start in the upper half of the interval, wild ones from the unknown y
+        auto start = [&](Kangaroo &kangaroo) {
+            kangaroo.distance = random_below(rng, mean) + (kangaroo.tame ? width / 2 : BigInt(0));
+            kangaroo.position = context.pow(g, kangaroo.distance);
+            if (!kangaroo.tame)
+                kangaroo.position *= target;
+        };
+
+        Kangaroo herd[2] = {{true, context.get_one(), 0}, {false, context.get_one(), 0}};
+        for (auto &kangaroo : herd)
+            start(kangaroo);
+
+        for (BigInt steps = 0; steps < step_limit && !stop.load(std::memory_order_relaxed); steps += 1)
+            for (auto &kangaroo : herd) {
+                uint64_t hash = kangaroo.position.hash();
+                if ((hash & mask) == 0) {
+                    std::lock_guard<std::mutex> lock(points_mutex);
+                    auto [it, inserted] = points.try_emplace(hash, kangaroo.tame, kangaroo.distance);
+                    if (!inserted) {
+                        // a tame and a wild one on the same point give y, two of a kind follow the same path from
+                        // here on, so the later one starts over
+                        auto &[tame, distance] = it->second;
+                        if (tame != kangaroo.tame) {
+                            BigInt y = tame ? distance - kangaroo.distance : kangaroo.distance - distance;
+                            if (y >= 0 && y <= width && context.pow(g, y) == target && !stop.exchange(true))
+                                result = y + lower;
+                        }
+                        start(kangaroo);
+                        continue;
+                    }
+                }
+
+                int k = (int) ((hash >> 32) % PARTITIONS);
+                kangaroo.position *= jumps[k];
+                kangaroo.distance += jump_lengths[k];
+            }
+    });
+
+    return result;
+}
+
+BigInt discrete_logarithm_Pohlig_Hellman(const ModInt &g, const ModInt &h, const BigInt &order,
+                                         const Factorization &factorization) {
+    auto &context = g.get_context();
+    std::vector<BigInt> residues, moduli;
+    for (auto &[q, e] : factorization) {
+        // g_q = g^(order / q^e) has order q^e and gamma = g_q^(q^(e - 1)) has order q
+        BigInt prime_power = big_pow(q, e), cofactor = order / prime_power;
+        ModInt g_q = context.pow(g, cofactor), h_q = context.pow(h, cofactor);
+        ModInt gamma = context.pow(g_q, prime_power / q), g_q_inverse = context.pow(g_q, prime_power - 1);
+
+        // digit k of x in base q from (h_q g_q^(-x))^(q^(e - 1 - k)) = gamma^digit
+        BigInt x = 0, place = 1;
+        for (int k = 0; k < e; ++k, place *= q) {
+            ModInt y = context.pow(context.pow(g_q_inverse, x) * h_q, prime_power / (place * q));
+            BigInt digit = discrete_logarithm_rho(gamma, y, q);
+            if (digit < 0)
+                return -1;
+            x += digit * place;
+        }
+
+        residues.push_back(x);
+        moduli.push_back(prime_power);
+    }
+
+    BigInt x = solve_congruences(residues, moduli);
+    return context.pow(g, x) == h ? x : BigInt(-1);
+}
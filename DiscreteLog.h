@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Factorization.h"
+#include "ModContext.h"
+
+// Discrete logarithms x with g^x = h for residues of one context, g a unit. Each returns -1 if there is no such x.
+
+// Baby steps are kept in an open addressing table of residue hashes, at most this many of them.
+const size_t BSGS_BABY_STEPS = 1 << 20;
+
+// The smallest x in [0, bound). Up to BSGS_BABY_STEPS baby steps, giant steps cover the rest of the range.
+BigInt discrete_logarithm_BSGS(const ModInt& g, const ModInt& h, const BigInt& bound);
+
+// x in [0, q) for g of prime order q, when h^q = 1 means that h is a power of g (the subgroup of order q is cyclic).
+// Baby-step giant-step while its table fits in BSGS_BABY_STEPS, above that Pollard's rho with an r-adding walk:
+// get_factorization_threads() threads walk from random starts and meet at distinguished points of a shared table.
+BigInt discrete_logarithm_rho(const ModInt& g, const ModInt& h, const BigInt& q);
+
+// x in [lower, upper] by Pollard's kangaroos in about 2 sqrt(upper - lower) steps. Every thread runs a tame and a wild
+// kangaroo that share distinguished points. Returns -1 as well if they fail to meet within several times that.
+BigInt discrete_logarithm_kangaroo(const ModInt& g, const ModInt& h, const BigInt& lower, const BigInt& upper);
+
+// The smallest x >= 0 for g of the given order with its factorization. Pohlig-Hellman: x is found modulo every prime
+// power q^e of the order digit by digit, each digit by discrete_logarithm_rho in the subgroup of order q.
+BigInt discrete_logarithm_Pohlig_Hellman(const ModInt& g, const ModInt& h, const BigInt& order,
+                                         const Factorization& factorization);
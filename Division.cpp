@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "Division.h"
+#include "BigMath.h"
+
+static std::atomic<size_t> newton_threshold(2500);
+
+size_t get_newton_division_threshold() {
+    return newton_threshold.load(std::memory_order_relaxed);
+}
+
+void set_newton_division_threshold(size_t threshold) {
+    newton_threshold.store(std::max<size_t>(threshold, 2), std::memory_order_relaxed);
+}
+
+void divide_limbs(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if (bn == 1) {
+        r[0] = divide_limb(q, a, an, b[0]);
+        return;
+    }
+
+    size_t threshold = newton_threshold.load(std::memory_order_relaxed);
+    if (bn >= threshold && an - bn + 1 >= threshold)
+        divide_newton(q, r, a, an, b, bn);
+    else
+        divide_knuth(q, r, a, an, b, bn);
+}
+
+void divide_knuth(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    // normalize so that the top bit of the divisor is set, then every quotient estimate is off by at most 2
+    int shift = count_leading_zeros(b[bn - 1]);
+    // per-thread buffers, every limb is written below, so that division in a loop does not allocate
+    static thread_local std::vector<limb_t> v, u;
+    v.resize(bn);
+    u.resize(an + 1);
+    shift_left_limbs(v.data(), b, bn, shift);
+    u[an] = shift_left_limbs(u.data(), a, an, shift);
+
+    const double_limb_t base = (double_limb_t) 1 << LIMB_BITS;
+    limb_t v1 = v[bn - 1], v2 = v[bn - 2];
+    for (size_t j = an - bn + 1; j-- > 0;) {
+        double_limb_t numerator = ((double_limb_t) u[j + bn] << LIMB_BITS) | u[j + bn - 1];
+        double_limb_t q_hat = numerator / v1, r_hat = numerator % v1;
+        while (q_hat >= base || q_hat * v2 > ((r_hat << LIMB_BITS) | u[j + bn - 2])) {
+            q_hat--;
+            r_hat += v1;
+            if (r_hat >= base)
+                break;
+        }
+
+        limb_t borrow = subtract_multiply_limb(u.data() + j, v.data(), bn, (limb_t) q_hat);
+        limb_t top = u[j + bn];
+        u[j + bn] = top - borrow;
+        if (top < borrow) {
+            // the estimate was one too large
+            q_hat--;
+            u[j + bn] += add_limbs(u.data() + j, u.data() + j, bn, v.data(), bn);
+        }
+
+        q[j] = (limb_t) q_hat;
+    }
+
+    shift_right_limbs(r, u.data(), bn, shift);
+}
+
+// floor(B^(2n) / b) for a normalized n-limb b, B = 2^64. The reciprocal of the upper half is refined
+// with one Newton step x += x * (B^(2n) - b * x) / B^(2n) and then corrected to the exact value.
+static BigInt reciprocal(const limb_t *b, size_t n) {
+    if (n <= 2) {
+        std::vector<limb_t> numerator(2 * n + 1), q(n + 2), r(n);
+        numerator[2 * n] = 1;
+        if (n == 1) {
+            r[0] = divide_limb(q.data(), numerator.data(), numerator.size(), b[0]);
+        } else {
+            divide_knuth(q.data(), r.data(), numerator.data(), numerator.size(), b, n);
+        }
+        return BigInt(std::move(q), 1);
+    }
+
+    size_t h = (n + 1) / 2;
+    BigInt d(std::span<const limb_t>(b, n), 1);
+    BigInt x = reciprocal(b + n - h, h) << (int) ((n - h) * LIMB_BITS);
+    int precision = (int) (2 * n * LIMB_BITS);
+
+    BigInt e = (BigInt(1) << precision) - d * x;
+    x += (x * e) >> precision;
+
+    BigInt remainder = (BigInt(1) << precision) - d * x;
+    while (remainder < 0) {
+        x -= 1;
+        remainder += d;
+    }
+    while (remainder >= d) {
+        x += 1;
+        remainder -= d;
+    }
+
+    return x;
+}
+
+void divide_newton(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    int shift = count_leading_zeros(b[bn - 1]);
+    std::vector<limb_t> v(bn), u(an + 1);
+    shift_left_limbs(v.data(), b, bn, shift);
+    u[an] = shift_left_limbs(u.data(), a, an, shift);
+
+    BigInt divisor(v, 1), inverse = reciprocal(v.data(), bn);
+    int block_bits = (int) (bn * LIMB_BITS);
+
+    // long division in base B^bn: every step divides a 2bn-limb number below divisor * B^bn,
+    // the quotient estimate from the reciprocal is at most 3 too small
+    std::fill(q, q + an - bn + 1, 0);
+    BigInt remainder;
+    size_t blocks = (u.size() + bn - 1) / bn;
+    for (size_t i = blocks; i-- > 0;) {
+        size_t lo = i * bn, hi = std::min(u.size(), lo + bn);
+        BigInt x = (remainder << block_bits) + BigInt(std::span<const limb_t>(u.data() + lo, hi - lo), 1);
+
+        BigInt q_block = ((x >> (block_bits - LIMB_BITS)) * inverse) >> (block_bits + LIMB_BITS);
+        remainder = x - q_block * divisor;
+        while (remainder >= divisor) {
+            remainder -= divisor;
+            q_block += 1;
+        }
+
+        auto q_limbs = q_block.get_limbs();
+        for (size_t k = 0; k < q_limbs.size() && lo + k < an - bn + 1; ++k)
+            q[lo + k] = q_limbs[k];
+    }
+
+    auto r_limbs = remainder.get_limbs();
+    std::vector<limb_t> normalized_r(bn);
+    std::copy(r_limbs.begin(), r_limbs.end(), normalized_r.begin());
+    shift_right_limbs(r, normalized_r.data(), bn, shift);
+}
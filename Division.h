@@ -0,0 +1,16 @@
+#pragma once
+
+#include "LimbMath.h"
+
+// Newton reciprocal division is used once both the divisor and the quotient have at least this many limbs,
+// Knuth's algorithm D below that.
+size_t get_newton_division_threshold();
+void set_newton_division_threshold(size_t); // safe to call while other threads divide
+
+// q = a / b and r = a % b for an >= bn and b[bn - 1] != 0, q gets an - bn + 1 limbs and r gets bn limbs.
+// Outputs must not overlap the inputs.
+void divide_limbs(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+
+// single algorithms, bn >= 2
+void divide_knuth(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+void divide_newton(limb_t* q, limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
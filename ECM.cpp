@@ -0,0 +1,194 @@
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "ECM.h"
+#include "Instrumentation.h"
+#include "ModContext.h"
+#include "NumberTheory.h"
+#include "Primes.h"
+
+namespace {
+
+// point of a Montgomery curve B y^2 = x^3 + A x^2 + x in projective X : Z coordinates, y is never needed
+struct Point {
+    ModInt x, z;
+};
+
+// a24 = (A + 2) / 4
+Point doubled(const Point &p, const ModInt &a24) {
+    ModInt sum = p.x + p.z, difference = p.x - p.z;
+    sum.square();
+    difference.square();
+    ModInt t = sum - difference;
+    return {sum * difference, t * (difference + a24 * t)};
+}
+
+// p + q from p, q and p - q
+Point added(const Point &p, const Point &q, const Point &difference) {
+    ModInt u = (p.x - p.z) * (q.x + q.z), v = (p.x + p.z) * (q.x - q.z);
+    ModInt x = u + v, z = u - v;
+    x.square();
+    z.square();
+    return {difference.z * x, difference.x * z};
+}
+
+// k * p for k >= 1 by the Montgomery ladder, which keeps r1 - r0 = p
+Point multiplied(const Point &p, unsigned long long k, const ModInt &a24) {
+    Point r0 = p, r1 = doubled(p, a24);
+    for (int bit = LIMB_BITS - 2 - count_leading_zeros(k); bit >= 0; --bit) {
+        if ((k >> bit) & 1) {
+            r0 = added(r1, r0, p);
+            r1 = doubled(r1, a24);
+        } else {
+            r1 = added(r1, r0, p);
+            r0 = doubled(r0, a24);
+        }
+    }
+
+    return r0;
+}
+
+// One curve with Suyama's parametrization by sigma, which makes the group order divisible by 12.
+// Returns a divider of n, which is n if the curve failed or stop was set.
+BigInt run_curve(const ModContext &context, unsigned long long sigma, unsigned long long b1, unsigned long long b2,
+                 const std::atomic<bool> &stop) {
+    const BigInt &n = context.get_modulus();
+
+    // u = sigma^2 - 5, v = 4 sigma, starting point (u^3 : v^3), a24 = (v - u)^3 (3u + v) / (16 u^3 v)
+    ModInt s(context, BigInt((long long) sigma));
+    ModInt u = s * s - ModInt(context, 5), v = s + s;
+    v += v;
+    ModInt u3 = u * u * u, v3 = v * v * v;
+
+    BigInt denominator = (ModInt(context, 16) * u3 * v).to_BigInt();
+    BigInt g = gcd(denominator, n);
+    if (g != 1)
+        return g;
+
+    ModInt v_u = v - u;
+    ModInt a24 = v_u * v_u * v_u * (u + u + u + v) * ModInt(context, inverse_modulo(denominator, n));
+    Point q{u3, v3};
+
+    // stage 1: q = (product of the largest prime powers up to b1) * q
+    PrimeIterator primes(2);
+    unsigned long long count = 0;
+    for (unsigned long long p = primes.next(); p <= b1; p = primes.next()) {
+        if (++count % 256 == 0 && stop.load(std::memory_order_relaxed))
+            return n;
+
+        unsigned long long power = p;
+        while (power <= b1 / p)
+            power *= p;
+        q = multiplied(q, power, a24);
+    }
+
+    g = gcd(q.z.to_BigInt(), n);
+    if (g != 1)
+        return g;
+
+    // stage 2, baby steps j * q for odd j < d / 2, giant steps k * d * q. A prime k * d +- j divides the order of q
+    // modulo a prime divider exactly when x(k d q) z(j q) = x(j q) z(k d q). A prime above 7 only meets the j coprime
+    // to d, the others are computed because the chain of differential additions runs through every odd j. Primes in
+    // (b1, b2] are streamed in increasing order, so the giant steps only move forward, and a prime k * d + j reuses
+    // the comparison of a prime k * d - j.
+    unsigned long long d = b2 >= 2310 * 50 ? 2310 : 210;
+    std::vector<Point> baby(d / 2, q);
+    Point q2 = doubled(q, a24);
+    if (d / 2 > 3)
+        baby[3] = added(q2, q, q);
+    for (unsigned long long j = 5; j < d / 2; j += 2)
+        baby[j] = added(baby[j - 2], q2, baby[j - 4]);
+
+    PrimeIterator stage2_primes(b1 + 1);
+    unsigned long long p = stage2_primes.next();
+    unsigned long long k = std::max<unsigned long long>(1, (p + d / 2) / d);
+    Point step = multiplied(q, d, a24);
+    Point giant = multiplied(q, k * d, a24), previous = k > 1 ? multiplied(q, (k - 1) * d, a24) : giant;
+
+    ModInt product = context.get_one();
+    std::vector<bool> compared(d / 2); // the j of the current k already in the product
+    for (count = 0; p <= b2; p = stage2_primes.next()) {
+        if (++count % 4096 == 0 && stop.load(std::memory_order_relaxed))
+            return n;
+
+        // p = k d +- j with j <= d / 2, j = d / 2 would make p a multiple of d / 2
+        for (; (p + d / 2) / d > k; ++k) {
+            Point next = k == 1 ? doubled(giant, a24) : added(giant, step, previous);
+            previous = giant;
+            giant = next;
+            compared.assign(d / 2, false);
+        }
+        unsigned long long j = p > k * d ? p - k * d : k * d - p;
+        if (j < d / 2 && !compared[j]) {
+            compared[j] = true;
+            product *= giant.x * baby[j].z - baby[j].x * giant.z;
+        }
+    }
+
+    g = gcd(product.to_BigInt(), n);
+    return g == 1 ? n : g;
+}
+
+}
+
+ECMParameters get_ECM_parameters(int digits) {
+    // bounds and expected numbers of curves from the GMP-ECM tables
+    static const struct {
+        int digits;
+        ECMParameters parameters;
+    } table[] = {
+            {15, {2000,     0, 25}},
+            {20, {11000,    0, 90}},
+            {25, {50000,    0, 300}},
+            {30, {250000,   0, 700}},
+            {35, {1000000,  0, 1800}},
+            {40, {3000000,  0, 5100}},
+            {45, {11000000, 0, 10600}},
+    };
+
+    for (auto &row : table)
+        if (digits <= row.digits)
+            return row.parameters;
+    return table[std::size(table) - 1].parameters;
+}
+
+BigInt get_divider_ECM(const BigInt &n, const ECMParameters &parameters) {
+    unsigned long long b1 = parameters.b1, b2 = parameters.b2 == 0 ? 100 * b1 : std::max(parameters.b2, b1);
+
+    // workers take curves from a shared counter, the first proper divider cancels the rest
+    ModContext context(n);
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned> next_curve(0);
+    std::mutex result_mutex;
+    BigInt result = n;
+
+    auto worker = [&]() {
+        for (unsigned curve; !stop.load(std::memory_order_relaxed) && (curve = next_curve++) < parameters.curves;) {
+            std::mt19937_64 rng(b1 * 1000003 + curve);
+            unsigned long long sigma = 6 + rng() % ((1ULL << 32) - 6);
+            INSTRUMENT_COUNT(ECM_CURVES, context.get_size());
+
+            BigInt divider = run_curve(context, sigma, b1, b2, stop);
+            if (divider != n) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                if (!stop.exchange(true))
+                    result = divider;
+            }
+        }
+    };
+
+    unsigned threads = std::min(get_factorization_threads(), parameters.curves);
+    if (threads <= 1)
+        worker();
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker);
+        for (auto &thread : pool)
+            thread.join();
+    }
+
+    return result;
+}
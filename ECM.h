@@ -0,0 +1,19 @@
+#pragma once
+
+#include "BigMath.h"
+
+// Bounds of Lenstra's elliptic curve method. Stage 1 multiplies the starting point by every prime power up to b1,
+// stage 2 catches one more prime in (b1, b2].
+struct ECMParameters
+{
+	unsigned long long b1 = 11000;
+	unsigned long long b2 = 0; // 0 means 100 * b1
+	unsigned curves = 90;
+};
+
+// Runs up to parameters.curves Montgomery curves over get_factorization_threads() threads,
+// returns n if none of them found a proper divider.
+BigInt get_divider_ECM(const BigInt& n, const ECMParameters& parameters = ECMParameters());
+
+// Recommended bounds for finding a prime divider of up to the given number of decimal digits.
+ECMParameters get_ECM_parameters(int digits);
@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include "Factorization.h"
+#include "NumberTheory.h"
+
+namespace {
+
+struct BigIntHash {
+    size_t operator()(const BigInt &a) const {
+        uint64_t h = a.get_sign();
+        for (limb_t x : a.get_limbs())
+            h = (h ^ x) * 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 32);
+    }
+};
+
+// most recently used first, guarded by cache_mutex
+std::mutex cache_mutex;
+size_t cache_capacity = 4096;
+std::list<std::pair<BigInt, Factorization>> cache_entries;
+std::unordered_map<BigInt, std::list<std::pair<BigInt, Factorization>>::iterator, BigIntHash> cache_index;
+
+void evict_to_capacity() {
+    while (cache_entries.size() > cache_capacity) {
+        cache_index.erase(cache_entries.back().first);
+        cache_entries.pop_back();
+    }
+}
+
+bool find_cached(const BigInt &n, Factorization &result) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache_index.find(n);
+    if (it == cache_index.end())
+        return false;
+
+    cache_entries.splice(cache_entries.begin(), cache_entries, it->second);
+    result = it->second->second;
+    return true;
+}
+
+void store_cached(const BigInt &n, const Factorization &factorization) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (cache_capacity == 0 || cache_index.count(n) != 0)
+        return;
+
+    cache_entries.emplace_front(n, factorization);
+    cache_index.emplace(n, cache_entries.begin());
+    evict_to_capacity();
+}
+
+}
+
+Factorization factorize(const BigInt &n) {
+    if (n < 1) throw "NumberIsNotPositive";
+
+    Factorization result;
+    if (n == 1 || find_cached(n, result))
+        return result;
+
+    auto primes = factorization_PollardRho(n);
+    std::sort(primes.begin(), primes.end());
+    for (size_t i = 0; i < primes.size(); ++i) {
+        if (i == 0 || primes[i] != primes[i - 1])
+            result.push_back({primes[i], 0});
+        result.back().exponent++;
+    }
+
+    store_cached(n, result);
+    return result;
+}
+
+std::vector<Factorization> factorize_batch(std::span<const BigInt> numbers) {
+    for (auto &n : numbers)
+        if (n < 1) throw "NumberIsNotPositive";
+
+    // the largest numbers go first, so that no thread is left with a long one at the end
+    std::vector<size_t> order(numbers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return numbers[a].get_number_of_limbs() > numbers[b].get_number_of_limbs();
+    });
+
+    std::vector<Factorization> result(numbers.size());
+    unsigned total = get_factorization_threads();
+    unsigned threads = (unsigned) std::min<size_t>(total, numbers.size());
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        if (threads > 1)
+            set_factorization_threads_of_this_thread(std::max(1u, total / threads));
+        for (size_t i; (i = next++) < order.size();)
+            result[order[i]] = factorize(numbers[order[i]]);
+    };
+
+    if (threads <= 1)
+        worker();
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker);
+        for (auto &thread : pool)
+            thread.join();
+    }
+
+    return result;
+}
+
+size_t get_factorization_cache_capacity() {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    return cache_capacity;
+}
+
+void set_factorization_cache_capacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    cache_capacity = capacity;
+    evict_to_capacity();
+}
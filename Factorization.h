@@ -0,0 +1,24 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "BigMath.h"
+
+struct PrimePower
+{
+	BigInt prime;
+	int exponent;
+};
+
+typedef std::vector<PrimePower> Factorization; // increasing primes, empty for 1
+
+// Factorization of n >= 1 by factorization_PollardRho. Results are kept in a process-wide LRU cache shared by the
+// multiplicative functions, so repeated queries for the same n are a lookup.
+Factorization factorize(const BigInt& n);
+
+// Factorizations of every number, largest first over get_factorization_threads() threads. Each thread takes the next
+// number when it is done with the previous one and races rho over its share of the threads.
+std::vector<Factorization> factorize_batch(std::span<const BigInt> numbers);
+
+size_t get_factorization_cache_capacity();
+void set_factorization_cache_capacity(size_t); // in numbers, 0 disables the cache, shrinking evicts the oldest
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <type_traits>
+#include <utility>
+#include "Instrumentation.h"
+#include "ModContext.h"
+
+// Unsigned integer of a fixed number of bits, a multiple of 64, in limbs on the stack. Arithmetic wraps modulo 2^Bits
+// like the unsigned types. Every loop runs over the compile-time number of limbs, so the compiler unrolls it, and
+// every operation but the conversions from and to BigInt is constexpr.
+template<size_t Bits>
+class FixedInt
+{
+	static_assert(Bits > 0 && Bits % LIMB_BITS == 0, "FixedInt needs a positive multiple of 64 bits");
+
+public:
+	static constexpr size_t LIMBS = Bits / LIMB_BITS;
+
+private:
+	std::array<limb_t, LIMBS> limbs{}; // least significant limb first
+
+public:
+	constexpr FixedInt() = default;
+	constexpr FixedInt(limb_t a) { limbs[0] = a; }
+	constexpr explicit FixedInt(const std::array<limb_t, LIMBS>& a) : limbs(a) {}
+	explicit FixedInt(const BigInt& a) // throws "NumberDoesNotFit" for a negative a or one of more than Bits bits
+	{
+		auto source = a.get_limbs();
+		if (a < 0 || source.size() > LIMBS) throw "NumberDoesNotFit";
+		std::copy(source.begin(), source.end(), limbs.begin());
+	}
+
+	operator BigInt() const { return BigInt(std::span<const limb_t>(limbs), 1); }
+
+	constexpr limb_t operator[](size_t i) const { return limbs[i]; }
+	constexpr limb_t& operator[](size_t i) { return limbs[i]; }
+	constexpr const std::array<limb_t, LIMBS>& get_limbs() const { return limbs; }
+
+	constexpr bool is_zero() const
+	{
+		for (limb_t x : limbs)
+			if (x != 0)
+				return false;
+		return true;
+	}
+	constexpr bool is_odd() const { return limbs[0] & 1; }
+	constexpr size_t bit_length() const
+	{
+		for (size_t i = LIMBS; i-- > 0;)
+			if (limbs[i] != 0)
+				return (i + 1) * LIMB_BITS - std::countl_zero(limbs[i]);
+		return 0;
+	}
+	constexpr bool get_bit(size_t i) const { return (limbs[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1; }
+
+	// in place, returning the carry out of the top limb or the borrow into it; b may alias this
+	constexpr limb_t add(const FixedInt& b)
+	{
+		limb_t carry = 0;
+		for (size_t i = 0; i < LIMBS; ++i)
+		{
+			double_limb_t s = (double_limb_t) limbs[i] + b.limbs[i] + carry;
+			limbs[i] = (limb_t) s;
+			carry = (limb_t) (s >> LIMB_BITS);
+		}
+		return carry;
+	}
+	constexpr limb_t subtract(const FixedInt& b)
+	{
+		limb_t borrow = 0;
+		for (size_t i = 0; i < LIMBS; ++i)
+		{
+			double_limb_t d = (double_limb_t) limbs[i] - b.limbs[i] - borrow;
+			limbs[i] = (limb_t) d;
+			borrow = (limb_t) (d >> LIMB_BITS) & 1;
+		}
+		return borrow;
+	}
+	// this / 2 with top as the bit shifted in from above
+	constexpr void halve(limb_t top = 0)
+	{
+		for (size_t i = 0; i + 1 < LIMBS; ++i)
+			limbs[i] = (limbs[i] >> 1) | (limbs[i + 1] << (LIMB_BITS - 1));
+		limbs[LIMBS - 1] = (limbs[LIMBS - 1] >> 1) | (top << (LIMB_BITS - 1));
+	}
+
+	// the whole product, of Bits + OtherBits bits
+	template<size_t OtherBits>
+	constexpr FixedInt<Bits + OtherBits> multiply_full(const FixedInt<OtherBits>& b) const
+	{
+		FixedInt<Bits + OtherBits> r;
+		for (size_t i = 0; i < LIMBS; ++i)
+		{
+			limb_t carry = 0;
+			for (size_t j = 0; j < FixedInt<OtherBits>::LIMBS; ++j)
+			{
+				double_limb_t p = (double_limb_t) limbs[i] * b[j] + r[i + j] + carry;
+				r[i + j] = (limb_t) p;
+				carry = (limb_t) (p >> LIMB_BITS);
+			}
+			r[i + FixedInt<OtherBits>::LIMBS] = carry;
+		}
+		return r;
+	}
+
+	constexpr FixedInt& operator+=(const FixedInt& b) { add(b); return *this; }
+	constexpr FixedInt& operator-=(const FixedInt& b) { subtract(b); return *this; }
+	constexpr FixedInt& operator*=(const FixedInt& b) // the low Bits bits of the product
+	{
+		FixedInt r;
+		for (size_t i = 0; i < LIMBS; ++i)
+		{
+			limb_t carry = 0;
+			for (size_t j = 0; i + j < LIMBS; ++j)
+			{
+				double_limb_t p = (double_limb_t) limbs[i] * b.limbs[j] + r.limbs[i + j] + carry;
+				r.limbs[i + j] = (limb_t) p;
+				carry = (limb_t) (p >> LIMB_BITS);
+			}
+		}
+		return *this = r;
+	}
+	constexpr FixedInt& operator<<=(int shift)
+	{
+		size_t limb_shift = (size_t) shift / LIMB_BITS, bit_shift = (size_t) shift % LIMB_BITS;
+		for (size_t i = LIMBS; i-- > 0;)
+		{
+			limb_t high = i >= limb_shift ? limbs[i - limb_shift] : 0;
+			limb_t low = i >= limb_shift + 1 ? limbs[i - limb_shift - 1] : 0;
+			limbs[i] = bit_shift == 0 ? high : (high << bit_shift) | (low >> (LIMB_BITS - bit_shift));
+		}
+		return *this;
+	}
+	constexpr FixedInt& operator>>=(int shift)
+	{
+		size_t limb_shift = (size_t) shift / LIMB_BITS, bit_shift = (size_t) shift % LIMB_BITS;
+		for (size_t i = 0; i < LIMBS; ++i)
+		{
+			limb_t low = i + limb_shift < LIMBS ? limbs[i + limb_shift] : 0;
+			limb_t high = i + limb_shift + 1 < LIMBS ? limbs[i + limb_shift + 1] : 0;
+			limbs[i] = bit_shift == 0 ? low : (low >> bit_shift) | (high << (LIMB_BITS - bit_shift));
+		}
+		return *this;
+	}
+
+	friend constexpr FixedInt operator+(FixedInt a, const FixedInt& b) { return a += b; }
+	friend constexpr FixedInt operator-(FixedInt a, const FixedInt& b) { return a -= b; }
+	friend constexpr FixedInt operator*(FixedInt a, const FixedInt& b) { return a *= b; }
+	friend constexpr FixedInt operator<<(FixedInt a, int shift) { return a <<= shift; }
+	friend constexpr FixedInt operator>>(FixedInt a, int shift) { return a >>= shift; }
+
+	constexpr bool operator==(const FixedInt&) const = default;
+	constexpr std::strong_ordering operator<=>(const FixedInt& b) const
+	{
+		for (size_t i = LIMBS; i-- > 0;)
+			if (limbs[i] != b.limbs[i])
+				return limbs[i] <=> b.limbs[i];
+		return std::strong_ordering::equal;
+	}
+};
+
+// a^(-1) mod m for an odd m by the binary extended Euclidean algorithm, 0 if a and m are not coprime or m = 1
+template<size_t Bits>
+constexpr FixedInt<Bits> inverse_modulo(const FixedInt<Bits>& a, const FixedInt<Bits>& m)
+{
+	// u = x1 a and v = x2 a modulo m, v stays odd
+	FixedInt<Bits> u = a, v = m, x1 = 1, x2 = 0;
+	auto halve = [&](FixedInt<Bits>& x)
+	{
+		limb_t carry = x.is_odd() ? x.add(m) : 0;
+		x.halve(carry);
+	};
+
+	if (m == 1)
+		return 0;
+	while (!u.is_zero())
+	{
+		while (!u.is_odd())
+		{
+			u.halve();
+			halve(x1);
+		}
+		// both odd now, the smaller one becomes v and the even difference u
+		if (u < v)
+		{
+			std::swap(u, v);
+			std::swap(x1, x2);
+		}
+		u.subtract(v);
+		if (x1.subtract(x2))
+			x1.add(m);
+	}
+
+	return v == 1 ? x2 : FixedInt<Bits>(0);
+}
+
+template<size_t Bits>
+class FixedModInt;
+
+// Montgomery arithmetic modulo a fixed odd modulus below 2^Bits, the fixed-width counterpart of ModContext for a
+// modulus whose size is known at compile time. Values in Montgomery form a * 2^Bits mod m go through multiply, square,
+// add, subtract and power, which are constexpr. convert, get_one and pow give FixedModInt residues with the interface
+// of ModInt, so code templated on the context runs on either.
+template<size_t Bits>
+class FixedMontgomery
+{
+public:
+	typedef FixedInt<Bits> Number;
+	static constexpr size_t LIMBS = Number::LIMBS;
+
+private:
+	Number modulus, one, r_squared; // R mod m and R^2 mod m for R = 2^Bits
+	limb_t inverse = 0;             // -m^(-1) mod 2^64
+
+	// 2 a mod m for a < m
+	constexpr Number double_modulo(Number a) const
+	{
+		limb_t carry = a.add(a);
+		if (carry != 0 || a >= modulus)
+			a.subtract(modulus);
+		return a;
+	}
+
+	// sliding window over the n limbs of e, with the widths of ModContext::pow
+	constexpr Number power(const Number& a, const limb_t* e, size_t n) const
+	{
+		size_t bits = 0;
+		for (size_t i = n; i-- > 0;)
+			if (e[i] != 0)
+			{
+				bits = (i + 1) * LIMB_BITS - std::countl_zero(e[i]);
+				break;
+			}
+		if (bits == 0)
+			return one;
+
+		auto bit = [&](size_t i) { return (e[i / LIMB_BITS] >> (i % LIMB_BITS)) & 1; };
+		const size_t thresholds[] = {7, 25, 81, 241, 673, 1793};
+		int w = 1;
+		while (w <= 6 && bits > thresholds[w - 1])
+			w++;
+
+		Number odd_powers[1 << 6] = {a}, a_squared = square(a); // up to w = 7
+		for (size_t i = 1; i < ((size_t) 1 << (w - 1)); ++i)
+			odd_powers[i] = multiply(odd_powers[i - 1], a_squared);
+
+		Number result = one;
+		bool started = false;
+		for (size_t i = bits; i-- > 0;)
+		{
+			if (!bit(i))
+			{
+				result = square(result);
+				continue;
+			}
+
+			size_t j = i + 1 >= (size_t) w ? i + 1 - w : 0;
+			while (!bit(j))
+				j++;
+			size_t window = 0;
+			for (size_t k = i + 1; k-- > j;)
+				window = 2 * window + bit(k);
+
+			if (started)
+			{
+				for (size_t k = j; k <= i; ++k)
+					result = square(result);
+				result = multiply(result, odd_powers[window >> 1]);
+			}
+			else
+			{
+				result = odd_powers[window >> 1];
+				started = true;
+			}
+			i = j;
+		}
+
+		return result;
+	}
+
+public:
+	constexpr explicit FixedMontgomery(const Number& m) : modulus(m) // throws "ModulusIsNotOdd"
+	{
+		if (!m.is_odd()) throw "ModulusIsNotOdd";
+
+		// Newton's iteration doubles the correct low bits of m^(-1), m is its own inverse modulo 8
+		limb_t x = m[0];
+		for (int i = 0; i < 5; ++i)
+			x *= 2 - m[0] * x;
+		inverse = -x;
+
+		// R mod m by doubling the highest power of 2 below m. R^2 mod m is 2^Bits in Montgomery form, the power of 2,
+		// whose form is 2 R mod m.
+		size_t bits = m.bit_length();
+		Number r;
+		if (bits > 1)
+			r[(bits - 1) / LIMB_BITS] = (limb_t) 1 << ((bits - 1) % LIMB_BITS);
+		for (size_t i = bits - 1; i < Bits; ++i)
+			r = double_modulo(r);
+		one = r;
+		r_squared = power(double_modulo(r), FixedInt<64>(Bits));
+	}
+
+	constexpr const Number& get_modulus_number() const { return modulus; }
+	BigInt get_modulus() const { return modulus; }
+	static constexpr size_t get_size() { return LIMBS; }
+
+	// CIOS: a b / R mod m for a b < R m, interleaving the rows of the product with the reduction
+	constexpr Number multiply(const Number& a, const Number& b) const
+	{
+		if (!std::is_constant_evaluated())
+			INSTRUMENT_COUNT(MODULAR_MULTIPLICATIONS, LIMBS);
+
+		limb_t t[LIMBS + 2] = {};
+		for (size_t i = 0; i < LIMBS; ++i)
+		{
+			limb_t carry = 0;
+			for (size_t j = 0; j < LIMBS; ++j)
+			{
+				double_limb_t p = (double_limb_t) a[j] * b[i] + t[j] + carry;
+				t[j] = (limb_t) p;
+				carry = (limb_t) (p >> LIMB_BITS);
+			}
+			double_limb_t s = (double_limb_t) t[LIMBS] + carry;
+			t[LIMBS] = (limb_t) s;
+			t[LIMBS + 1] = (limb_t) (s >> LIMB_BITS);
+
+			// adding q m clears the lowest limb, which is shifted out
+			limb_t q = t[0] * inverse;
+			double_limb_t p = (double_limb_t) q * modulus[0] + t[0];
+			carry = (limb_t) (p >> LIMB_BITS);
+			for (size_t j = 1; j < LIMBS; ++j)
+			{
+				p = (double_limb_t) q * modulus[j] + t[j] + carry;
+				t[j - 1] = (limb_t) p;
+				carry = (limb_t) (p >> LIMB_BITS);
+			}
+			s = (double_limb_t) t[LIMBS] + carry;
+			t[LIMBS - 1] = (limb_t) s;
+			t[LIMBS] = t[LIMBS + 1] + (limb_t) (s >> LIMB_BITS);
+		}
+
+		Number r;
+		for (size_t j = 0; j < LIMBS; ++j)
+			r[j] = t[j];
+		if (t[LIMBS] != 0 || r >= modulus)
+			r.subtract(modulus);
+		return r;
+	}
+	constexpr Number square(const Number& a) const { return multiply(a, a); }
+	constexpr Number add(Number a, const Number& b) const
+	{
+		limb_t carry = a.add(b);
+		if (carry != 0 || a >= modulus)
+			a.subtract(modulus);
+		return a;
+	}
+	constexpr Number subtract(Number a, const Number& b) const
+	{
+		if (a.subtract(b))
+			a.add(modulus);
+		return a;
+	}
+	constexpr Number halve(Number a) const
+	{
+		limb_t carry = a.is_odd() ? a.add(modulus) : 0;
+		a.halve(carry);
+		return a;
+	}
+	constexpr Number to_form(const Number& a) const { return multiply(a, r_squared); } // any a < 2^Bits
+	constexpr Number from_form(const Number& a) const { return multiply(a, Number(1)); }
+	constexpr const Number& get_one_form() const { return one; }
+	template<size_t ExponentBits>
+	constexpr Number power(const Number& a, const FixedInt<ExponentBits>& e) const
+	{
+		return power(a, e.get_limbs().data(), FixedInt<ExponentBits>::LIMBS);
+	}
+	Number power(const Number& a, const BigInt& e) const
+	{
+		auto limbs = e.get_limbs();
+		return power(a, limbs.data(), limbs.size());
+	}
+
+	FixedModInt<Bits> convert(const BigInt& a) const;
+	constexpr FixedModInt<Bits> get_one() const;
+	FixedModInt<Bits> pow(const FixedModInt<Bits>& a, const BigInt& p) const; // a^|p|
+};
+
+// the arithmetic runs at compile time: Fermat's little theorem modulo the prime 2^128 - 159, and inverses
+static_assert([]
+{
+	constexpr FixedInt<128> m(std::array<limb_t, 2>{0xffffffffffffff61, 0xffffffffffffffff});
+	FixedMontgomery<128> context(m);
+	FixedInt<128> a = context.to_form(12345), e = m;
+	e.subtract(1);
+	return context.from_form(context.power(a, e)) == 1 && context.from_form(context.power(a, m)) == 12345;
+}());
+static_assert(inverse_modulo(FixedInt<64>(3), FixedInt<64>(7)) == 5);
+static_assert(inverse_modulo(FixedInt<128>(std::array<limb_t, 2>{0, 1}), FixedInt<128>(3)) == 1);
+static_assert(inverse_modulo(FixedInt<64>(6), FixedInt<64>(9)) == 0);
+
+// residue modulo the modulus of a FixedMontgomery with the interface of ModInt, the context must outlive it
+template<size_t Bits>
+class FixedModInt
+{
+	typedef FixedInt<Bits> Number;
+
+	const FixedMontgomery<Bits>* context;
+	Number value; // Montgomery form
+
+	friend class FixedMontgomery<Bits>;
+	constexpr FixedModInt(const Number& form, const FixedMontgomery<Bits>& context) : context(&context), value(form) {}
+
+public:
+	FixedModInt(const FixedMontgomery<Bits>& context, const BigInt& a) : context(&context)
+	{
+		// a of up to Bits bits goes into Montgomery form as it is, others are reduced first
+		if (a >= 0 && a.get_limbs().size() <= Number::LIMBS)
+			value = context.to_form(Number(a));
+		else
+		{
+			BigInt r = a % context.get_modulus();
+			value = context.to_form(Number(r < 0 ? r + context.get_modulus() : r));
+		}
+	}
+
+	constexpr const FixedMontgomery<Bits>& get_context() const { return *context; }
+	constexpr const Number& get_form() const { return value; }
+	constexpr Number get_value() const { return context->from_form(value); }
+	BigInt to_BigInt() const { return get_value(); }
+	constexpr bool is_zero() const { return value.is_zero(); }
+
+	constexpr FixedModInt& operator+=(const FixedModInt& b) { value = context->add(value, b.value); return *this; }
+	constexpr FixedModInt& operator-=(const FixedModInt& b) { value = context->subtract(value, b.value); return *this; }
+	constexpr FixedModInt& operator*=(const FixedModInt& b) { value = context->multiply(value, b.value); return *this; }
+	constexpr FixedModInt& square() { value = context->square(value); return *this; }
+	constexpr FixedModInt& halve() { value = context->halve(value); return *this; }
+
+	friend constexpr bool operator==(const FixedModInt& a, const FixedModInt& b) { return a.value == b.value; }
+	friend constexpr FixedModInt operator+(FixedModInt a, const FixedModInt& b) { return a += b; }
+	friend constexpr FixedModInt operator-(FixedModInt a, const FixedModInt& b) { return a -= b; }
+	friend constexpr FixedModInt operator*(FixedModInt a, const FixedModInt& b) { return a *= b; }
+};
+
+template<size_t Bits>
+FixedModInt<Bits> FixedMontgomery<Bits>::convert(const BigInt& a) const
+{
+	return FixedModInt<Bits>(*this, a);
+}
+
+template<size_t Bits>
+constexpr FixedModInt<Bits> FixedMontgomery<Bits>::get_one() const
+{
+	return FixedModInt<Bits>(one, *this);
+}
+
+template<size_t Bits>
+FixedModInt<Bits> FixedMontgomery<Bits>::pow(const FixedModInt<Bits>& a, const BigInt& p) const
+{
+	return FixedModInt<Bits>(power(a.get_form(), p), *this);
+}
+
+// f(context) with the FixedMontgomery of 64, 128 or 256 bits that holds a positive odd modulus m of up to 256 bits,
+// otherwise with a ModContext. Both make residues with the interface of ModInt, so f is usually a generic lambda.
+template<class F>
+decltype(auto) with_modular_context(const BigInt& m, F&& f)
+{
+	if (m > 0 && (m.get_limbs()[0] & 1) != 0)
+		switch (m.get_number_of_limbs())
+		{
+		case 1:
+			return f(FixedMontgomery<64>(FixedInt<64>(m)));
+		case 2:
+			return f(FixedMontgomery<128>(FixedInt<128>(m)));
+		case 3:
+		case 4:
+			return f(FixedMontgomery<256>(FixedInt<256>(m)));
+		}
+
+	return f(ModContext(m));
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include "Instrumentation.h"
+
+namespace {
+
+struct CounterDescription {
+    const char *name, *help;
+};
+
+const CounterDescription COUNTERS[INSTRUMENTED_COUNTERS] = {
+    {"multiplications", "BigInt products by limbs of the longer operand"},
+    {"divisions", "BigInt quotients and remainders by limbs of the dividend"},
+    {"modular_multiplications", "ModInt products and squares by limbs of the modulus"},
+    {"allocations", "heap blocks of BigInt limbs by their capacity in limbs"},
+    {"allocated_limbs", "limbs of the heap blocks of BigInt by their capacity in limbs"},
+    {"gcd_calls", "gcd calls by limbs of the longer operand"},
+    {"rho_iterations", "Pollard-Brent steps by limbs of the number being factored"},
+    {"miller_rabin_rounds", "strong probable prime tests to one base by limbs of the tested number"},
+    {"ecm_curves", "ECM curves by limbs of the number being factored"},
+};
+
+// live slots, the totals of ended threads and the timer names
+struct Registry {
+    std::mutex mutex;
+    std::vector<InstrumentationSlots *> slots;
+    uint64_t counters[INSTRUMENTED_COUNTERS][SIZE_CLASSES] = {};
+    uint64_t calls[MAX_TIMERS] = {}, nanoseconds[MAX_TIMERS] = {};
+    std::vector<std::string> timers;
+};
+
+Registry &get_registry() {
+    static Registry registry;
+    return registry;
+}
+
+std::string size_class_label(int c) {
+    size_t low = (size_t) 1 << c, high = 2 * low - 1;
+    if (c == SIZE_CLASSES - 1)
+        return std::to_string(low) + "+";
+    return low == high ? std::to_string(low) : std::to_string(low) + "-" + std::to_string(high);
+}
+
+}
+
+const char *get_counter_name(InstrumentedCounter counter) {
+    return COUNTERS[counter].name;
+}
+
+InstrumentationSlots::InstrumentationSlots() {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.slots.push_back(this);
+}
+
+InstrumentationSlots::~InstrumentationSlots() {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (unsigned i = 0; i < INSTRUMENTED_COUNTERS; ++i)
+        for (int c = 0; c < SIZE_CLASSES; ++c)
+            registry.counters[i][c] += counters[i][c].load(std::memory_order_relaxed);
+    for (int t = 0; t < MAX_TIMERS; ++t) {
+        registry.calls[t] += calls[t].load(std::memory_order_relaxed);
+        registry.nanoseconds[t] += nanoseconds[t].load(std::memory_order_relaxed);
+    }
+    std::erase(registry.slots, this);
+}
+
+int register_instrumentation_timer(const char *name) {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (size_t t = 0; t < registry.timers.size(); ++t)
+        if (registry.timers[t] == name)
+            return (int) t;
+
+    if (registry.timers.size() == MAX_TIMERS) throw "TooManyTimers";
+    registry.timers.push_back(name);
+    return (int) registry.timers.size() - 1;
+}
+
+uint64_t InstrumentationSnapshot::total(InstrumentedCounter counter) const {
+    uint64_t sum = 0;
+    for (int c = 0; c < SIZE_CLASSES; ++c)
+        sum += counters[counter][c];
+    return sum;
+}
+
+InstrumentationSnapshot get_instrumentation_snapshot() {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    InstrumentationSnapshot snapshot;
+    std::vector<uint64_t> calls(registry.calls, registry.calls + MAX_TIMERS);
+    std::vector<uint64_t> nanoseconds(registry.nanoseconds, registry.nanoseconds + MAX_TIMERS);
+    for (unsigned i = 0; i < INSTRUMENTED_COUNTERS; ++i)
+        for (int c = 0; c < SIZE_CLASSES; ++c)
+            snapshot.counters[i][c] = registry.counters[i][c];
+
+    for (auto *slots : registry.slots) {
+        for (unsigned i = 0; i < INSTRUMENTED_COUNTERS; ++i)
+            for (int c = 0; c < SIZE_CLASSES; ++c)
+                snapshot.counters[i][c] += slots->counters[i][c].load(std::memory_order_relaxed);
+        for (int t = 0; t < MAX_TIMERS; ++t) {
+            calls[t] += slots->calls[t].load(std::memory_order_relaxed);
+            nanoseconds[t] += slots->nanoseconds[t].load(std::memory_order_relaxed);
+        }
+    }
+
+    for (size_t t = 0; t < registry.timers.size(); ++t)
+        if (calls[t] != 0)
+            snapshot.timers.push_back({registry.timers[t], calls[t], nanoseconds[t]});
+
+    return snapshot;
+}
+
+void reset_instrumentation() {
+    auto &registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    // timer names stay registered, their ids are cached at the call sites
+    for (auto &counter : registry.counters)
+        std::fill(counter, counter + SIZE_CLASSES, 0);
+    std::fill(registry.calls, registry.calls + MAX_TIMERS, 0);
+    std::fill(registry.nanoseconds, registry.nanoseconds + MAX_TIMERS, 0);
+    for (auto *slots : registry.slots) {
+        for (auto &counter : slots->counters)
+            for (auto &slot : counter)
+                slot.store(0, std::memory_order_relaxed);
+        for (int t = 0; t < MAX_TIMERS; ++t) {
+            slots->calls[t].store(0, std::memory_order_relaxed);
+            slots->nanoseconds[t].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::string to_JSON(const InstrumentationSnapshot &snapshot) {
+    std::string result = "{\n  \"counters\": {";
+    for (unsigned i = 0; i < INSTRUMENTED_COUNTERS; ++i) {
+        auto counter = (InstrumentedCounter) i;
+        result += std::string(i ? "," : "") + "\n    \"" + COUNTERS[i].name + "\": {\"total\": " +
+                  std::to_string(snapshot.total(counter)) + ", \"size_classes\": {";
+        bool first = true;
+        for (int c = 0; c < SIZE_CLASSES; ++c)
+            if (snapshot.counters[i][c] != 0) {
+                result += std::string(first ? "" : ", ") + "\"" + size_class_label(c) + "\": " +
+                          std::to_string(snapshot.counters[i][c]);
+                first = false;
+            }
+        result += "}}";
+    }
+
+    result += "\n  },\n  \"timers\": {";
+    for (size_t t = 0; t < snapshot.timers.size(); ++t) {
+        auto &timer = snapshot.timers[t];
+        char seconds[32];
+        std::snprintf(seconds, sizeof(seconds), "%.9f", timer.nanoseconds * 1e-9);
+        result += std::string(t ? "," : "") + "\n    \"" + timer.name + "\": {\"calls\": " +
+                  std::to_string(timer.calls) + ", \"seconds\": " + seconds + "}";
+    }
+    result += "\n  }\n}\n";
+
+    return result;
+}
+
+std::string to_Prometheus(const InstrumentationSnapshot &snapshot) {
+    std::string result;
+    for (unsigned i = 0; i < INSTRUMENTED_COUNTERS; ++i) {
+        std::string metric = std::string("bigint_") + COUNTERS[i].name + "_total";
+        result += "# HELP " + metric + " " + COUNTERS[i].help + "\n# TYPE " + metric + " counter\n";
+        for (int c = 0; c < SIZE_CLASSES; ++c)
+            if (snapshot.counters[i][c] != 0)
+                result += metric + "{size_class=\"" + size_class_label(c) + "\"} " +
+                          std::to_string(snapshot.counters[i][c]) + "\n";
+    }
+
+    result += "# HELP bigint_calls_total calls of the timed functions\n# TYPE bigint_calls_total counter\n";
+    for (auto &timer : snapshot.timers)
+        result += "bigint_calls_total{function=\"" + timer.name + "\"} " + std::to_string(timer.calls) + "\n";
+
+    result += "# HELP bigint_seconds_total time in the timed functions, nested calls included\n"
+              "# TYPE bigint_seconds_total counter\n";
+    for (auto &timer : snapshot.timers) {
+        char seconds[32];
+        std::snprintf(seconds, sizeof(seconds), "%.9f", timer.nanoseconds * 1e-9);
+        result += "bigint_seconds_total{function=\"" + timer.name + "\"} " + seconds + "\n";
+    }
+
+    return result;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counters and timers on the hot paths, compiled in only with BIGINT_INSTRUMENTATION defined (the CMake option of the
+// same name). Without it the INSTRUMENT_ macros expand to nothing, and snapshots are empty.
+//
+// Every thread accumulates into its own slots, which only it writes, so counting takes no lock and no atomic
+// read-modify-write. Snapshots add up the slots of the live threads and the totals left by the threads that ended.
+
+enum InstrumentedCounter : unsigned
+{
+	MULTIPLICATIONS,          // BigInt products, by the longer operand
+	DIVISIONS,                // BigInt quotients and remainders, by the dividend
+	MODULAR_MULTIPLICATIONS,  // ModInt products and squares, by the modulus
+	ALLOCATIONS,              // heap blocks of BigInt limbs, by their capacity
+	ALLOCATED_LIMBS,          // the limbs of those blocks
+	GCD_CALLS,                // by the longer operand
+	RHO_ITERATIONS,           // steps of Pollard-Brent walks, by the number being factored
+	MILLER_RABIN_ROUNDS,      // strong probable prime tests to one base, by the tested number
+	ECM_CURVES,               // by the number being factored
+	INSTRUMENTED_COUNTERS
+};
+
+const char* get_counter_name(InstrumentedCounter);
+
+// Size class c holds sizes of [2^c, 2^(c + 1)) limbs, the last one everything from 2^(SIZE_CLASSES - 1) limbs on.
+const int SIZE_CLASSES = 16;
+
+inline int get_size_class(size_t limbs)
+{
+	int c = 0;
+	while (limbs > 1 && c < SIZE_CLASSES - 1)
+		limbs >>= 1, ++c;
+	return c;
+}
+
+// Timers are registered by name on the first call of the code they time, at most this many.
+const int MAX_TIMERS = 64;
+
+struct InstrumentationSnapshot
+{
+	struct Timer
+	{
+		std::string name;
+		uint64_t calls, nanoseconds; // nanoseconds include nested calls of other timed functions
+	};
+
+	uint64_t counters[INSTRUMENTED_COUNTERS][SIZE_CLASSES] = {};
+	std::vector<Timer> timers; // in order of registration, only those called since the last reset
+
+	uint64_t total(InstrumentedCounter) const; // over all size classes
+};
+
+InstrumentationSnapshot get_instrumentation_snapshot();
+void reset_instrumentation(); // counts of other threads that run meanwhile may survive the reset
+
+std::string to_JSON(const InstrumentationSnapshot&);
+// counters as bigint_<name>_total{size_class="..."}, timers as bigint_calls_total and bigint_seconds_total by function
+std::string to_Prometheus(const InstrumentationSnapshot&);
+
+// the slots of one thread
+struct InstrumentationSlots
+{
+	std::atomic<uint64_t> counters[INSTRUMENTED_COUNTERS][SIZE_CLASSES] = {};
+	std::atomic<uint64_t> calls[MAX_TIMERS] = {}, nanoseconds[MAX_TIMERS] = {};
+
+	InstrumentationSlots();  // registers the slots for snapshots
+	~InstrumentationSlots(); // hands the counts over to the totals of ended threads
+};
+
+inline InstrumentationSlots& get_instrumentation_slots()
+{
+	static thread_local InstrumentationSlots slots;
+	return slots;
+}
+
+// only the owning thread writes, a relaxed load and store suffice
+inline void add_to_slot(std::atomic<uint64_t>& slot, uint64_t amount)
+{
+	slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void count_instrumented(InstrumentedCounter counter, size_t limbs, uint64_t amount = 1)
+{
+	add_to_slot(get_instrumentation_slots().counters[counter][get_size_class(limbs)], amount);
+}
+
+int register_instrumentation_timer(const char* name); // throws "TooManyTimers" beyond MAX_TIMERS
+
+// adds the time from its construction to its destruction to a timer
+class InstrumentationTimer
+{
+	int timer;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	explicit InstrumentationTimer(int timer) : timer(timer), start(std::chrono::steady_clock::now()) {}
+	~InstrumentationTimer()
+	{
+		auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		auto& slots = get_instrumentation_slots();
+		add_to_slot(slots.calls[timer], 1);
+		add_to_slot(slots.nanoseconds[timer], elapsed.count());
+	}
+
+	InstrumentationTimer(const InstrumentationTimer&) = delete;
+	InstrumentationTimer& operator=(const InstrumentationTimer&) = delete;
+};
+
+#ifdef BIGINT_INSTRUMENTATION
+#define INSTRUMENT_COUNT(counter, limbs) count_instrumented(counter, limbs)
+#define INSTRUMENT_ADD(counter, limbs, amount) count_instrumented(counter, limbs, amount)
+#define INSTRUMENT_TIME(name) \
+	static const int instrumentation_timer_id = register_instrumentation_timer(name); \
+	InstrumentationTimer instrumentation_timer(instrumentation_timer_id)
+#else
+#define INSTRUMENT_COUNT(counter, limbs) ((void) 0)
+#define INSTRUMENT_ADD(counter, limbs, amount) ((void) 0)
+#define INSTRUMENT_TIME(name) ((void) 0)
+#endif
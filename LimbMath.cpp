@@ -0,0 +1,202 @@
+#include "LimbMath.h"
+
+size_t normalized_size(const limb_t *a, size_t n) {
+    while (n > 0 && a[n - 1] == 0)
+        n--;
+    return n;
+}
+
+int compare_limbs(const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    an = normalized_size(a, an);
+    bn = normalized_size(b, bn);
+    if (an != bn)
+        return an > bn ? 1 : -1;
+
+    for (size_t i = an; i-- > 0;)
+        if (a[i] != b[i])
+            return a[i] > b[i] ? 1 : -1;
+
+    return 0;
+}
+
+limb_t add_limbs(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < bn; ++i) {
+        limb_t s = a[i] + carry;
+        carry = s < carry;
+        r[i] = s + b[i];
+        carry += r[i] < s;
+    }
+
+    return add_limb(r + bn, a + bn, an - bn, carry);
+}
+
+limb_t subtract_limbs(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < bn; ++i) {
+        limb_t d = a[i] - b[i];
+        limb_t next_borrow = a[i] < b[i];
+        next_borrow += d < borrow;
+        r[i] = d - borrow;
+        borrow = next_borrow;
+    }
+
+    return subtract_limb(r + bn, a + bn, an - bn, borrow);
+}
+
+limb_t add_limb(limb_t *r, const limb_t *a, size_t n, limb_t b) {
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = a[i] + b;
+        b = r[i] < b;
+    }
+
+    return b;
+}
+
+limb_t subtract_limb(limb_t *r, const limb_t *a, size_t n, limb_t b) {
+    for (size_t i = 0; i < n; ++i) {
+        limb_t borrow = a[i] < b;
+        r[i] = a[i] - b;
+        b = borrow;
+    }
+
+    return b;
+}
+
+limb_t multiply_limb(limb_t *r, const limb_t *a, size_t n, limb_t b) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double_limb_t t = (double_limb_t) a[i] * b + carry;
+        r[i] = (limb_t) t;
+        carry = (limb_t) (t >> LIMB_BITS);
+    }
+
+    return carry;
+}
+
+limb_t add_multiply_limb(limb_t *r, const limb_t *a, size_t n, limb_t b) {
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double_limb_t t = (double_limb_t) a[i] * b + r[i] + carry;
+        r[i] = (limb_t) t;
+        carry = (limb_t) (t >> LIMB_BITS);
+    }
+
+    return carry;
+}
+
+limb_t subtract_multiply_limb(limb_t *r, const limb_t *a, size_t n, limb_t b) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double_limb_t t = (double_limb_t) a[i] * b + borrow;
+        limb_t low = (limb_t) t;
+        borrow = (limb_t) (t >> LIMB_BITS) + (r[i] < low);
+        r[i] -= low;
+    }
+
+    return borrow;
+}
+
+void multiply_schoolbook(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if (an == 0 || bn == 0) {
+        for (size_t i = 0; i < an + bn; ++i)
+            r[i] = 0;
+        return;
+    }
+
+    r[an] = multiply_limb(r, a, an, b[0]);
+    for (size_t j = 1; j < bn; ++j)
+        r[an + j] = add_multiply_limb(r + j, a, an, b[j]);
+}
+
+limb_t divide_limb(limb_t *q, const limb_t *a, size_t n, limb_t d) {
+    limb_t remainder = 0;
+    for (size_t i = n; i-- > 0;) {
+        double_limb_t t = ((double_limb_t) remainder << LIMB_BITS) | a[i];
+        q[i] = (limb_t) (t / d);
+        remainder = (limb_t) (t % d);
+    }
+
+    return remainder;
+}
+
+limb_t modulo_limb(const limb_t *a, size_t n, limb_t d) {
+    limb_t remainder = 0;
+    for (size_t i = n; i-- > 0;)
+        remainder = (limb_t) ((((double_limb_t) remainder << LIMB_BITS) | a[i]) % d);
+
+    return remainder;
+}
+
+limb_t shift_left_limbs(limb_t *r, const limb_t *a, size_t n, unsigned shift) {
+    if (shift == 0) {
+        for (size_t i = n; i-- > 0;)
+            r[i] = a[i];
+        return 0;
+    }
+
+    limb_t out = n > 0 ? a[n - 1] >> (LIMB_BITS - shift) : 0;
+    for (size_t i = n; i-- > 1;)
+        r[i] = (a[i] << shift) | (a[i - 1] >> (LIMB_BITS - shift));
+    if (n > 0)
+        r[0] = a[0] << shift;
+
+    return out;
+}
+
+limb_t shift_right_limbs(limb_t *r, const limb_t *a, size_t n, unsigned shift) {
+    if (shift == 0) {
+        for (size_t i = 0; i < n; ++i)
+            r[i] = a[i];
+        return 0;
+    }
+
+    limb_t out = n > 0 ? a[0] << (LIMB_BITS - shift) : 0;
+    for (size_t i = 0; i + 1 < n; ++i)
+        r[i] = (a[i] >> shift) | (a[i + 1] << (LIMB_BITS - shift));
+    if (n > 0)
+        r[n - 1] = a[n - 1] >> shift;
+
+    return out;
+}
+
+size_t bit_length(const limb_t *a, size_t n) {
+    n = normalized_size(a, n);
+    return n == 0 ? 0 : n * LIMB_BITS - count_leading_zeros(a[n - 1]);
+}
+
+limb_t get_bits(const limb_t *a, size_t n, size_t from, int count) {
+    size_t i = from / LIMB_BITS;
+    unsigned shift = from % LIMB_BITS;
+    if (i >= n || count == 0)
+        return 0;
+
+    limb_t bits = a[i] >> shift;
+    if (shift != 0 && i + 1 < n)
+        bits |= a[i + 1] << (LIMB_BITS - shift);
+
+    return count == LIMB_BITS ? bits : bits & (((limb_t) 1 << count) - 1);
+}
+
+void select_limbs(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t condition) {
+    limb_t mask = -condition;
+    for (size_t i = 0; i < n; ++i)
+        r[i] = (a[i] & mask) | (b[i] & ~mask);
+}
+
+void swap_limbs_if(limb_t *a, limb_t *b, size_t n, limb_t condition) {
+    limb_t mask = -condition;
+    for (size_t i = 0; i < n; ++i) {
+        limb_t t = (a[i] ^ b[i]) & mask;
+        a[i] ^= t;
+        b[i] ^= t;
+    }
+}
+
+int count_leading_zeros(limb_t x) {
+    return __builtin_clzll(x);
+}
+
+int count_trailing_zeros(limb_t x) {
+    return __builtin_ctzll(x);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+typedef uint64_t limb_t;
+typedef unsigned __int128 double_limb_t;
+
+const int LIMB_BITS = 64;
+
+// Low-level operations on magnitudes stored as little-endian arrays of limbs.
+// Lengths are passed explicitly, output arrays must be allocated by the caller.
+
+size_t normalized_size(const limb_t* a, size_t n); // length without leading zero limbs
+int compare_limbs(const limb_t* a, size_t an, const limb_t* b, size_t bn); // -1, 0 or 1
+
+limb_t add_limbs(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // an >= bn, writes an limbs, returns carry
+limb_t subtract_limbs(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // an >= bn, writes an limbs, returns borrow
+limb_t add_limb(limb_t* r, const limb_t* a, size_t n, limb_t b); // returns carry
+limb_t subtract_limb(limb_t* r, const limb_t* a, size_t n, limb_t b); // returns borrow
+
+limb_t multiply_limb(limb_t* r, const limb_t* a, size_t n, limb_t b); // r = a * b, returns high limb
+limb_t add_multiply_limb(limb_t* r, const limb_t* a, size_t n, limb_t b); // r += a * b, returns carry
+limb_t subtract_multiply_limb(limb_t* r, const limb_t* a, size_t n, limb_t b); // r -= a * b, returns borrow
+void multiply_schoolbook(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // writes an + bn limbs
+
+limb_t divide_limb(limb_t* q, const limb_t* a, size_t n, limb_t d); // q = a / d, returns a % d
+limb_t modulo_limb(const limb_t* a, size_t n, limb_t d); // a % d
+limb_t shift_left_limbs(limb_t* r, const limb_t* a, size_t n, unsigned shift); // 0 <= shift < 64, returns bits shifted out
+limb_t shift_right_limbs(limb_t* r, const limb_t* a, size_t n, unsigned shift); // 0 <= shift < 64, returns bits shifted out
+
+size_t bit_length(const limb_t* a, size_t n); // position of the highest set bit plus one, 0 for zero
+limb_t get_bits(const limb_t* a, size_t n, size_t from, int count); // count <= 64 bits starting at bit from, zero past the end
+
+// constant-time helpers, condition is 0 or 1 and no branch or memory access depends on it
+void select_limbs(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t condition); // r = condition ? a : b
+void swap_limbs_if(limb_t* a, limb_t* b, size_t n, limb_t condition);
+
+int count_leading_zeros(limb_t x); // x != 0
+int count_trailing_zeros(limb_t x); // x != 0
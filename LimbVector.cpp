@@ -0,0 +1,70 @@
+#include <utility>
+#include "Instrumentation.h"
+#include "LimbVector.h"
+
+void LimbVector::grow(size_t n) {
+    size_t new_capacity = std::max(n, 2 * capacity_);
+    INSTRUMENT_COUNT(ALLOCATIONS, new_capacity);
+    INSTRUMENT_ADD(ALLOCATED_LIMBS, new_capacity, new_capacity);
+    limb_t *block = new limb_t[new_capacity];
+    std::copy(limbs, limbs + length, block);
+
+    if (!is_inline())
+        delete[] limbs;
+    limbs = block;
+    capacity_ = new_capacity;
+}
+
+LimbVector::LimbVector(const LimbVector &other) : LimbVector() {
+    assign(other.begin(), other.end());
+}
+
+LimbVector::LimbVector(LimbVector &&other) noexcept : LimbVector() {
+    swap(other);
+}
+
+LimbVector &LimbVector::operator=(const LimbVector &other) {
+    if (this != &other)
+        assign(other.begin(), other.end());
+    return *this;
+}
+
+LimbVector &LimbVector::operator=(LimbVector &&other) noexcept {
+    if (this != &other)
+        swap(other);
+    return *this;
+}
+
+LimbVector::~LimbVector() {
+    if (!is_inline())
+        delete[] limbs;
+}
+
+void LimbVector::swap(LimbVector &other) noexcept {
+    if (!is_inline() && !other.is_inline()) {
+        std::swap(limbs, other.limbs);
+        std::swap(capacity_, other.capacity_);
+        std::swap(length, other.length);
+        return;
+    }
+
+    // at least one side is inline: the heap block, if any, changes owner and the inline limbs are copied across
+    LimbVector &small = is_inline() ? *this : other, &large = is_inline() ? other : *this;
+    limb_t saved[INLINE_LIMBS];
+    size_t saved_length = small.length;
+    std::copy(small.limbs, small.limbs + saved_length, saved);
+
+    if (large.is_inline()) {
+        std::copy(large.limbs, large.limbs + large.length, small.local);
+        small.length = large.length;
+    } else {
+        small.limbs = large.limbs;
+        small.capacity_ = large.capacity_;
+        small.length = large.length;
+        large.limbs = large.local;
+        large.capacity_ = INLINE_LIMBS;
+    }
+
+    std::copy(saved, saved + saved_length, large.local);
+    large.length = saved_length;
+}
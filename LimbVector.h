@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include "LimbMath.h"
+
+// Growable array of limbs that keeps up to INLINE_LIMBS limbs inside the object and moves to the heap only beyond
+// that, so numbers up to 128 bits never allocate. New limbs from resize are zero.
+class LimbVector
+{
+public:
+	static const size_t INLINE_LIMBS = 2;
+
+private:
+	limb_t* limbs;     // local or a heap block of capacity limbs
+	size_t length;
+	size_t capacity_;
+	limb_t local[INLINE_LIMBS];
+
+	bool is_inline() const { return limbs == local; }
+	void grow(size_t n);
+
+public:
+	LimbVector() : limbs(local), length(0), capacity_(INLINE_LIMBS) {}
+	LimbVector(const LimbVector&);
+	LimbVector(LimbVector&&) noexcept;
+	LimbVector& operator=(const LimbVector&);
+	LimbVector& operator=(LimbVector&&) noexcept;
+	~LimbVector();
+
+	size_t size() const { return length; }
+	size_t capacity() const { return capacity_; }
+	bool empty() const { return length == 0; }
+	limb_t* data() { return limbs; }
+	const limb_t* data() const { return limbs; }
+	limb_t* begin() { return limbs; }
+	limb_t* end() { return limbs + length; }
+	const limb_t* begin() const { return limbs; }
+	const limb_t* end() const { return limbs + length; }
+	limb_t& operator[](size_t i) { return limbs[i]; }
+	limb_t operator[](size_t i) const { return limbs[i]; }
+	limb_t& back() { return limbs[length - 1]; }
+
+	void reserve(size_t n) { if (n > capacity_) grow(n); }
+	void resize(size_t n)
+	{
+		reserve(n);
+		if (n > length)
+			std::fill(limbs + length, limbs + n, 0);
+		length = n;
+	}
+	void clear() { length = 0; }
+	void push_back(limb_t x)
+	{
+		reserve(length + 1);
+		limbs[length++] = x;
+	}
+	template <class Iterator>
+	void assign(Iterator first, Iterator last)
+	{
+		size_t n = std::distance(first, last);
+		reserve(n);
+		std::copy(first, last, limbs);
+		length = n;
+	}
+
+	void swap(LimbVector&) noexcept;
+};
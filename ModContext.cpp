@@ -0,0 +1,341 @@
+#include <algorithm>
+#include "Instrumentation.h"
+#include "ModContext.h"
+#include "Multiplication.h"
+
+ModContext::ModContext(const BigInt &m) : modulus(m) {
+    if (m == 0) throw "DividedByZero";
+    if (m < 0) throw "ModulusIsNotPositive";
+
+    auto m_limbs = m.get_limbs();
+    n.assign(m_limbs.begin(), m_limbs.end());
+    size = n.size();
+    montgomery = (n[0] & 1) == 1;
+    inverse = 0;
+
+    int r_bits = (int) (size * LIMB_BITS);
+    if (montgomery) {
+        // Newton iteration for n^(-1) mod 2^64, every step doubles the number of correct bits
+        limb_t x = n[0];
+        for (int i = 0; i < 5; ++i)
+            x *= 2 - n[0] * x;
+        inverse = -x;
+
+        BigInt r2 = (BigInt(1) << (2 * r_bits)) % modulus;
+        r_squared.assign(size, 0);
+        std::copy(r2.get_limbs().begin(), r2.get_limbs().end(), r_squared.begin());
+    } else {
+        BigInt factor = (BigInt(1) << (2 * r_bits)) / modulus;
+        barrett_factor.assign(factor.get_limbs().begin(), factor.get_limbs().end());
+    }
+
+    one.resize(size);
+    to_form(one.data(), 1);
+}
+
+const BigInt &ModContext::get_modulus() const {
+    return modulus;
+}
+
+size_t ModContext::get_size() const {
+    return size;
+}
+
+bool ModContext::is_montgomery() const {
+    return montgomery;
+}
+
+void ModContext::reduce(limb_t *r, limb_t *t) const {
+    if (montgomery) {
+        // REDC: add multiples of n that clear the lower half, the upper half is then t / R < 2n. The carry out of
+        // every row is kept in the limb it cleared and added to the upper half in one pass at the end, so no carry
+        // runs for a data-dependent number of limbs.
+        for (size_t i = 0; i < size; ++i) {
+            limb_t m = t[i] * inverse;
+            t[i] = add_multiply_limb(t + i, n.data(), size, m);
+        }
+        t[2 * size] += add_limbs(t + size, t + size, size, t, size);
+
+        // n is subtracted when that does not borrow or the top limb is set, without branching for pow_constant_time
+        limb_t borrow = subtract_limbs(t, t + size, size, n.data(), size);
+        select_limbs(r, t, t + size, size, t[2 * size] | (borrow ^ 1));
+        return;
+    }
+
+    // Barrett: q = floor(floor(t / B^(size - 1)) * factor / B^(size + 1)) is at most 2 below t / n
+    static thread_local std::vector<limb_t> q, qn, remainder;
+    size_t fn = barrett_factor.size();
+    q.resize(size + 1 + fn);
+    multiply_limbs(q.data(), t + size - 1, size + 1, barrett_factor.data(), fn);
+
+    qn.resize(fn + size);
+    multiply_limbs(qn.data(), q.data() + size + 1, fn, n.data(), size);
+
+    remainder.resize(size + 1);
+    subtract_limbs(remainder.data(), t, size + 1, qn.data(), std::min(qn.size(), size + 1));
+    while (compare_limbs(remainder.data(), size + 1, n.data(), size) >= 0)
+        subtract_limbs(remainder.data(), remainder.data(), size + 1, n.data(), size);
+
+    std::copy(remainder.begin(), remainder.begin() + size, r);
+}
+
+void ModContext::multiply(limb_t *r, const limb_t *a, const limb_t *b) const {
+    if (a == b) {
+        square(r, a);
+        return;
+    }
+    INSTRUMENT_COUNT(MODULAR_MULTIPLICATIONS, size);
+
+    static thread_local std::vector<limb_t> t;
+    t.resize(2 * size + 1);
+    multiply_limbs(t.data(), a, size, b, size);
+    t[2 * size] = 0;
+    reduce(r, t.data());
+}
+
+void ModContext::square(limb_t *r, const limb_t *a) const {
+    INSTRUMENT_COUNT(MODULAR_MULTIPLICATIONS, size);
+    static thread_local std::vector<limb_t> t;
+    t.resize(2 * size + 1);
+    square_limbs(t.data(), a, size);
+    t[2 * size] = 0;
+    reduce(r, t.data());
+}
+
+void ModContext::add(limb_t *r, const limb_t *a, const limb_t *b) const {
+    limb_t carry = add_limbs(r, a, size, b, size);
+    if (carry != 0 || compare_limbs(r, size, n.data(), size) >= 0)
+        subtract_limbs(r, r, size, n.data(), size);
+}
+
+void ModContext::subtract(limb_t *r, const limb_t *a, const limb_t *b) const {
+    limb_t borrow = subtract_limbs(r, a, size, b, size);
+    if (borrow != 0)
+        add_limbs(r, r, size, n.data(), size);
+}
+
+void ModContext::halve(limb_t *r, const limb_t *a) const {
+    if ((n[0] & 1) == 0) throw "ModulusIsNotOdd";
+
+    // an odd residue becomes even by adding n, which stays correct in Montgomery form as well
+    limb_t carry = 0;
+    if (a[0] & 1)
+        carry = add_limbs(r, a, size, n.data(), size);
+    else
+        std::copy(a, a + size, r);
+
+    shift_right_limbs(r, r, size, 1);
+    r[size - 1] |= carry << (LIMB_BITS - 1);
+}
+
+void ModContext::to_form(limb_t *r, const BigInt &a) const {
+    BigInt residue = a % modulus;
+    std::fill(r, r + size, 0);
+    std::copy(residue.get_limbs().begin(), residue.get_limbs().end(), r);
+
+    if (montgomery)
+        multiply(r, r, r_squared.data());
+}
+
+BigInt ModContext::from_form(const limb_t *a) const {
+    std::vector<limb_t> result(a, a + size);
+    if (montgomery) {
+        std::vector<limb_t> t(2 * size + 1);
+        std::copy(a, a + size, t.begin());
+        reduce(result.data(), t.data());
+    }
+
+    return BigInt(std::move(result), 1);
+}
+
+ModInt ModContext::convert(const BigInt &a) const {
+    return ModInt(*this, a);
+}
+
+ModInt ModContext::get_one() const {
+    ModInt result(*this, 0);
+    result.value = one;
+    return result;
+}
+
+// window width for a sliding window over an exponent of the given number of bits
+static int window_size(size_t bits) {
+    static const size_t thresholds[] = {7, 25, 81, 241, 673, 1793};
+    int w = 1;
+    while (w <= 6 && bits > thresholds[w - 1])
+        w++;
+    return w;
+}
+
+ModInt ModContext::pow(const ModInt &a, const BigInt &p) const {
+    auto e = p.get_limbs();
+    size_t bits = bit_length(e.data(), e.size());
+    if (bits == 0)
+        return get_one();
+
+    // odd powers a, a^3, ..., a^(2^w - 1)
+    int w = window_size(bits);
+    std::vector<ModInt> odd_powers(1, a);
+    ModInt a_squared = a;
+    a_squared.square();
+    for (size_t i = 1; i < ((size_t) 1 << (w - 1)); ++i)
+        odd_powers.push_back(odd_powers.back() * a_squared);
+
+    // left to right, every window starts and ends with a set bit, so it maps to an odd power
+    ModInt result = get_one();
+    bool started = false;
+    for (size_t i = bits; i-- > 0;) {
+        if (get_bits(e.data(), e.size(), i, 1) == 0) {
+            result.square();
+            continue;
+        }
+
+        size_t j = i + 1 >= (size_t) w ? i + 1 - w : 0;
+        while (get_bits(e.data(), e.size(), j, 1) == 0)
+            j++;
+
+        if (started) {
+            for (size_t k = j; k <= i; ++k)
+                result.square();
+            result *= odd_powers[get_bits(e.data(), e.size(), j, i - j + 1) >> 1];
+        } else {
+            result = odd_powers[get_bits(e.data(), e.size(), j, i - j + 1) >> 1];
+            started = true;
+        }
+        i = j;
+    }
+
+    return result;
+}
+
+ModInt ModContext::pow_constant_time(const ModInt &a, const BigInt &p) const {
+    if (!montgomery) throw "ModulusIsNotOdd";
+
+    // Montgomery ladder keeping r1 = r0 * a, the swap replaces the branch on the bit. The products are schoolbook
+    // whatever the size, the faster ones branch on the signs and magnitudes of their partial results.
+    ModInt r0 = get_one(), r1 = a;
+    auto e = p.get_limbs();
+    std::vector<limb_t> t(2 * size + 1);
+    limb_t swapped = 0;
+    for (size_t i = e.size() * LIMB_BITS; i-- > 0;) {
+        limb_t bit = get_bits(e.data(), e.size(), i, 1);
+        swap_limbs_if(r0.value.data(), r1.value.data(), size, bit ^ swapped);
+        swapped = bit;
+
+        multiply_schoolbook(t.data(), r1.value.data(), size, r0.value.data(), size);
+        t[2 * size] = 0;
+        reduce(r1.value.data(), t.data());
+        square_schoolbook(t.data(), r0.value.data(), size);
+        t[2 * size] = 0;
+        reduce(r0.value.data(), t.data());
+    }
+    swap_limbs_if(r0.value.data(), r1.value.data(), size, swapped);
+
+    return r0;
+}
+
+ModInt ModContext::multi_pow(const ModInt &a, const BigInt &x, const ModInt &b, const BigInt &y) const {
+    auto ex = x.get_limbs(), ey = y.get_limbs();
+    size_t bits = std::max(bit_length(ex.data(), ex.size()), bit_length(ey.data(), ey.size()));
+    int w = bits <= 16 ? 1 : bits <= 256 ? 2 : 3;
+    size_t side = (size_t) 1 << w;
+
+    // table[i * side + j] = a^i * b^j for i, j < 2^w
+    std::vector<ModInt> table(side * side, get_one());
+    for (size_t j = 1; j < side; ++j)
+        table[j] = table[j - 1] * b;
+    for (size_t i = 1; i < side; ++i)
+        for (size_t j = 0; j < side; ++j)
+            table[i * side + j] = table[(i - 1) * side + j] * a;
+
+    // Straus: both exponents are scanned together in fixed windows of w bits
+    ModInt result = get_one();
+    bool started = false;
+    for (size_t k = (bits + w - 1) / w; k-- > 0;) {
+        if (started)
+            for (int s = 0; s < w; ++s)
+                result.square();
+
+        size_t index = get_bits(ex.data(), ex.size(), k * w, w) * side + get_bits(ey.data(), ey.size(), k * w, w);
+        if (index == 0)
+            continue;
+        if (started)
+            result *= table[index];
+        else
+            result = table[index];
+        started = true;
+    }
+
+    return result;
+}
+
+ModInt::ModInt(const ModContext &context, const BigInt &a) : context(&context), value(context.get_size()) {
+    context.to_form(value.data(), a);
+}
+
+const ModContext &ModInt::get_context() const {
+    return *context;
+}
+
+BigInt ModInt::to_BigInt() const {
+    return context->from_form(value.data());
+}
+
+bool ModInt::is_zero() const {
+    return std::all_of(value.begin(), value.end(), [](limb_t x) { return x == 0; });
+}
+
+uint64_t ModInt::hash() const {
+    uint64_t h = 0;
+    for (limb_t x : value)
+        h = (h ^ x) * 0x9E3779B97F4A7C15ULL;
+    // every bit of the result depends on every limb, callers take bit fields of it
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+ModInt &ModInt::operator+=(const ModInt &b) {
+    context->add(value.data(), value.data(), b.value.data());
+    return *this;
+}
+
+ModInt &ModInt::operator-=(const ModInt &b) {
+    context->subtract(value.data(), value.data(), b.value.data());
+    return *this;
+}
+
+ModInt &ModInt::operator*=(const ModInt &b) {
+    context->multiply(value.data(), value.data(), b.value.data());
+    return *this;
+}
+
+ModInt &ModInt::square() {
+    context->square(value.data(), value.data());
+    return *this;
+}
+
+ModInt &ModInt::halve() {
+    context->halve(value.data(), value.data());
+    return *this;
+}
+
+bool operator==(const ModInt &a, const ModInt &b) {
+    return a.value == b.value;
+}
+
+bool operator!=(const ModInt &a, const ModInt &b) {
+    return !(a == b);
+}
+
+ModInt operator+(ModInt a, const ModInt &b) {
+    return a += b;
+}
+
+ModInt operator-(ModInt a, const ModInt &b) {
+    return a -= b;
+}
+
+ModInt operator*(ModInt a, const ModInt &b) {
+    return a *= b;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vector>
+#include "BigMath.h"
+
+class ModInt;
+
+// Precomputed constants for arithmetic modulo a fixed positive modulus. Odd moduli keep residues in
+// Montgomery form a * R mod n with R = 2^(64 * size), even moduli fall back to Barrett reduction of plain residues.
+// A context is immutable after construction, so it can be shared between threads.
+class ModContext
+{
+	BigInt modulus;
+	std::vector<limb_t> n;     // modulus limbs
+	size_t size;               // number of limbs of every residue
+	bool montgomery;
+	limb_t inverse;            // -n^(-1) mod 2^64
+	std::vector<limb_t> r_squared; // R^2 mod n
+	std::vector<limb_t> barrett_factor; // floor(2^(128 * size) / n)
+	std::vector<limb_t> one;   // 1 in internal form
+
+	void reduce(limb_t* r, limb_t* t) const; // r = t / R mod n or t mod n, t has 2 * size + 1 limbs and is destroyed
+
+public:
+	explicit ModContext(const BigInt& modulus);
+
+	const BigInt& get_modulus() const;
+	size_t get_size() const;
+	bool is_montgomery() const;
+
+	// operations on residues of get_size() limbs in internal form, r may alias the arguments
+	void multiply(limb_t* r, const limb_t* a, const limb_t* b) const;
+	void square(limb_t* r, const limb_t* a) const;
+	void add(limb_t* r, const limb_t* a, const limb_t* b) const;
+	void subtract(limb_t* r, const limb_t* a, const limb_t* b) const;
+	void halve(limb_t* r, const limb_t* a) const; // a / 2, needs an odd modulus
+	void to_form(limb_t* r, const BigInt& a) const;
+	BigInt from_form(const limb_t* a) const;
+
+	ModInt convert(const BigInt& a) const;
+	ModInt get_one() const;
+	ModInt pow(const ModInt& a, const BigInt& p) const; // a^|p| with a sliding window
+	// a^|p| by a Montgomery ladder of schoolbook products: the sequence of operations and memory accesses depends only
+	// on the number of limbs of p and of the modulus, for exponents that must stay secret. Needs an odd modulus.
+	ModInt pow_constant_time(const ModInt& a, const BigInt& p) const;
+	ModInt multi_pow(const ModInt& a, const BigInt& x, const ModInt& b, const BigInt& y) const; // a^|x| * b^|y| in one pass
+};
+
+// residue modulo the modulus of a context, the context must outlive it
+class ModInt
+{
+	const ModContext* context;
+	std::vector<limb_t> value;
+
+	friend class ModContext;
+
+public:
+	ModInt(const ModContext& context, const BigInt& a);
+
+	const ModContext& get_context() const;
+	BigInt to_BigInt() const;
+	bool is_zero() const;
+	uint64_t hash() const; // of the internal form, so equal residues of one context hash alike
+
+	ModInt& operator+=(const ModInt&);
+	ModInt& operator-=(const ModInt&);
+	ModInt& operator*=(const ModInt&);
+	ModInt& square();
+	ModInt& halve();
+
+	friend bool operator==(const ModInt&, const ModInt&);
+};
+
+bool operator!=(const ModInt&, const ModInt&);
+ModInt operator+(ModInt, const ModInt&);
+ModInt operator-(ModInt, const ModInt&);
+ModInt operator*(ModInt, const ModInt&);
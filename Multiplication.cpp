@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "Multiplication.h"
+
+static std::atomic<size_t> karatsuba_threshold(32), karatsuba_square_threshold(64),
+        toom3_threshold(240), ntt_threshold(12000);
+
+MultiplicationThresholds get_multiplication_thresholds() {
+    MultiplicationThresholds t;
+    t.karatsuba = karatsuba_threshold.load(std::memory_order_relaxed);
+    t.karatsuba_square = karatsuba_square_threshold.load(std::memory_order_relaxed);
+    t.toom3 = toom3_threshold.load(std::memory_order_relaxed);
+    t.ntt = ntt_threshold.load(std::memory_order_relaxed);
+    return t;
+}
+
+void set_multiplication_thresholds(const MultiplicationThresholds &t) {
+    // Karatsuba and Toom-3 only shrink their subproducts from 4 limbs on
+    karatsuba_threshold.store(std::max<size_t>(t.karatsuba, 4), std::memory_order_relaxed);
+    karatsuba_square_threshold.store(std::max<size_t>(t.karatsuba_square, 4), std::memory_order_relaxed);
+    toom3_threshold.store(std::max<size_t>(t.toom3, 4), std::memory_order_relaxed);
+    ntt_threshold.store(std::max<size_t>(t.ntt, 1), std::memory_order_relaxed);
+}
+
+void multiply_limbs(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+
+    if (bn < karatsuba_threshold.load(std::memory_order_relaxed)) {
+        multiply_schoolbook(r, a, an, b, bn);
+        return;
+    }
+    if (bn >= ntt_threshold.load(std::memory_order_relaxed)) {
+        multiply_ntt(r, a, an, b, bn);
+        return;
+    }
+
+    if (an >= 2 * bn) {
+        // unbalanced operands: multiply b by slices of a of the same length
+        std::fill(r, r + an + bn, 0);
+        std::vector<limb_t> part(2 * bn);
+        for (size_t i = 0; i < an; i += bn) {
+            size_t len = std::min(bn, an - i);
+            multiply_limbs(part.data(), a + i, len, b, bn);
+            add_limbs(r + i, r + i, an + bn - i, part.data(), len + bn);
+        }
+        return;
+    }
+
+    if (bn >= toom3_threshold.load(std::memory_order_relaxed))
+        multiply_toom3(r, a, an, b, bn);
+    else
+        multiply_karatsuba(r, a, an, b, bn);
+}
+
+void square_limbs(limb_t *r, const limb_t *a, size_t n) {
+    if (n < karatsuba_square_threshold.load(std::memory_order_relaxed))
+        square_schoolbook(r, a, n);
+    else if (n >= ntt_threshold.load(std::memory_order_relaxed))
+        square_ntt(r, a, n);
+    else if (n >= toom3_threshold.load(std::memory_order_relaxed))
+        square_toom3(r, a, n);
+    else
+        square_karatsuba(r, a, n);
+}
+
+void square_schoolbook(limb_t *r, const limb_t *a, size_t n) {
+    if (n == 0)
+        return;
+
+    // every product a[i] * a[j] with i < j is computed once and then doubled
+    r[0] = 0;
+    r[2 * n - 1] = 0;
+    for (size_t i = 0; i + 1 < n; ++i)
+        r[i + 1] = 0;
+    for (size_t i = 0; i + 1 < n; ++i)
+        r[i + n] = add_multiply_limb(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    shift_left_limbs(r, r, 2 * n, 1);
+
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        double_limb_t sq = (double_limb_t) a[i] * a[i];
+        double_limb_t t = (double_limb_t) r[2 * i] + (limb_t) sq + carry;
+        r[2 * i] = (limb_t) t;
+        t = (double_limb_t) r[2 * i + 1] + (limb_t) (sq >> LIMB_BITS) + (limb_t) (t >> LIMB_BITS);
+        r[2 * i + 1] = (limb_t) t;
+        carry = (limb_t) (t >> LIMB_BITS);
+    }
+}
+
+void multiply_karatsuba(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+
+    size_t h = (an + 1) / 2;
+    if (bn <= h) {
+        // b does not reach the upper half of a: a * b = a0 * b + (a1 * b) << h
+        std::vector<limb_t> high(an - h + bn);
+        multiply_limbs(r, a, h, b, bn);
+        std::fill(r + h + bn, r + an + bn, 0);
+        multiply_limbs(high.data(), a + h, an - h, b, bn);
+        add_limbs(r + h, r + h, an + bn - h, high.data(), high.size());
+        return;
+    }
+
+    // a * b = z2 << 2h + ((a0 + a1)(b0 + b1) - z0 - z2) << h + z0
+    size_t an1 = an - h, bn1 = bn - h;
+    std::vector<limb_t> sa(h + 1), sb(h + 1), mid(2 * h + 2);
+    multiply_limbs(r, a, h, b, h);
+    multiply_limbs(r + 2 * h, a + h, an1, b + h, bn1);
+
+    sa[h] = add_limbs(sa.data(), a, h, a + h, an1);
+    sb[h] = add_limbs(sb.data(), b, h, b + h, bn1);
+    multiply_limbs(mid.data(), sa.data(), h + 1, sb.data(), h + 1);
+    subtract_limbs(mid.data(), mid.data(), mid.size(), r, 2 * h);
+    subtract_limbs(mid.data(), mid.data(), mid.size(), r + 2 * h, an1 + bn1);
+
+    add_limbs(r + h, r + h, an + bn - h, mid.data(), normalized_size(mid.data(), mid.size()));
+}
+
+void square_karatsuba(limb_t *r, const limb_t *a, size_t n) {
+    size_t h = (n + 1) / 2, n1 = n - h;
+    std::vector<limb_t> s(h + 1), mid(2 * h + 2);
+    square_limbs(r, a, h);
+    square_limbs(r + 2 * h, a + h, n1);
+
+    s[h] = add_limbs(s.data(), a, h, a + h, n1);
+    square_limbs(mid.data(), s.data(), h + 1);
+    subtract_limbs(mid.data(), mid.data(), mid.size(), r, 2 * h);
+    subtract_limbs(mid.data(), mid.data(), mid.size(), r + 2 * h, 2 * n1);
+
+    add_limbs(r + h, r + h, 2 * n - h, mid.data(), normalized_size(mid.data(), mid.size()));
+}
+
+// signed intermediate value of the Toom-3 evaluation and interpolation
+struct SignedLimbs
+{
+    std::vector<limb_t> mag;
+    int sign = 0;
+};
+
+static SignedLimbs make_signed(const limb_t *a, size_t n) {
+    SignedLimbs x;
+    x.mag.assign(a, a + normalized_size(a, n));
+    x.sign = x.mag.empty() ? 0 : 1;
+    return x;
+}
+
+// x += y_sign * |y|
+static void add_signed(SignedLimbs &x, const SignedLimbs &y, int y_sign) {
+    if (y.sign == 0)
+        return;
+    y_sign *= y.sign;
+    if (x.sign == 0) {
+        x.mag = y.mag;
+        x.sign = y_sign;
+        return;
+    }
+
+    size_t n = x.mag.size(), m = y.mag.size();
+    if (x.sign == y_sign) {
+        x.mag.resize(std::max(n, m) + 1);
+        x.mag.back() = add_limbs(x.mag.data(), x.mag.data(), std::max(n, m), y.mag.data(), m);
+    } else if (compare_limbs(x.mag.data(), n, y.mag.data(), m) >= 0) {
+        subtract_limbs(x.mag.data(), x.mag.data(), n, y.mag.data(), m);
+    } else {
+        x.mag.resize(m);
+        subtract_limbs(x.mag.data(), y.mag.data(), m, x.mag.data(), n);
+        x.sign = y_sign;
+    }
+
+    x.mag.resize(normalized_size(x.mag.data(), x.mag.size()));
+    if (x.mag.empty())
+        x.sign = 0;
+}
+
+static SignedLimbs sum_signed(const SignedLimbs &x, const SignedLimbs &y, int y_sign) {
+    SignedLimbs result = x;
+    add_signed(result, y, y_sign);
+    return result;
+}
+
+static void shift_left_signed(SignedLimbs &x, unsigned shift) {
+    x.mag.push_back(0);
+    x.mag.back() = shift_left_limbs(x.mag.data(), x.mag.data(), x.mag.size() - 1, shift);
+    x.mag.resize(normalized_size(x.mag.data(), x.mag.size()));
+}
+
+static void divide_signed_exact(SignedLimbs &x, limb_t d) {
+    if (d == 2)
+        shift_right_limbs(x.mag.data(), x.mag.data(), x.mag.size(), 1);
+    else
+        divide_limb(x.mag.data(), x.mag.data(), x.mag.size(), d);
+    x.mag.resize(normalized_size(x.mag.data(), x.mag.size()));
+    if (x.mag.empty())
+        x.sign = 0;
+}
+
+static SignedLimbs product_signed(const SignedLimbs &x, const SignedLimbs &y, bool square) {
+    SignedLimbs result;
+    if (x.sign == 0 || y.sign == 0)
+        return result;
+
+    result.mag.resize(x.mag.size() + y.mag.size());
+    if (square)
+        square_limbs(result.mag.data(), x.mag.data(), x.mag.size());
+    else
+        multiply_limbs(result.mag.data(), x.mag.data(), x.mag.size(), y.mag.data(), y.mag.size());
+    result.mag.resize(normalized_size(result.mag.data(), result.mag.size()));
+    result.sign = x.sign * y.sign;
+    return result;
+}
+
+// Toom-Cook 3 with evaluation at 0, 1, -1, -2, infinity and Bodrato's interpolation sequence
+static void toom3(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, bool square) {
+    size_t k = (std::max(an, bn) + 2) / 3;
+    auto piece = [k](const limb_t *x, size_t n, size_t i) {
+        size_t lo = std::min(n, i * k), hi = std::min(n, (i + 1) * k);
+        return make_signed(x + lo, hi - lo);
+    };
+
+    SignedLimbs a0 = piece(a, an, 0), a1 = piece(a, an, 1), a2 = piece(a, an, 2);
+    SignedLimbs b0 = piece(b, bn, 0), b1 = piece(b, bn, 1), b2 = piece(b, bn, 2);
+
+    auto evaluate = [](const SignedLimbs &x0, const SignedLimbs &x1, const SignedLimbs &x2,
+                       SignedLimbs &p1, SignedLimbs &pm1, SignedLimbs &pm2) {
+        SignedLimbs t = sum_signed(x0, x2, 1);
+        p1 = sum_signed(t, x1, 1);
+        pm1 = sum_signed(t, x1, -1);
+        pm2 = sum_signed(pm1, x2, 1);
+        shift_left_signed(pm2, 1);
+        add_signed(pm2, x0, -1);
+    };
+
+    SignedLimbs p1, pm1, pm2, q1, qm1, qm2;
+    evaluate(a0, a1, a2, p1, pm1, pm2);
+    if (!square)
+        evaluate(b0, b1, b2, q1, qm1, qm2);
+
+    SignedLimbs r0 = product_signed(a0, b0, square);
+    SignedLimbs r1 = product_signed(p1, square ? p1 : q1, square);
+    SignedLimbs rm1 = product_signed(pm1, square ? pm1 : qm1, square);
+    SignedLimbs rm2 = product_signed(pm2, square ? pm2 : qm2, square);
+    SignedLimbs r4 = product_signed(a2, b2, square);
+
+    SignedLimbs r3 = sum_signed(rm2, r1, -1);
+    divide_signed_exact(r3, 3);
+    add_signed(r1, rm1, -1);
+    divide_signed_exact(r1, 2);
+    SignedLimbs r2 = sum_signed(rm1, r0, -1);
+    r3 = sum_signed(r2, r3, -1);
+    divide_signed_exact(r3, 2);
+    SignedLimbs twice_r4 = r4;
+    shift_left_signed(twice_r4, 1);
+    add_signed(r3, twice_r4, 1);
+    add_signed(r2, r1, 1);
+    add_signed(r2, r4, -1);
+    add_signed(r1, r3, -1);
+
+    // all coefficients of the product polynomial are nonnegative
+    size_t n = an + bn;
+    std::fill(r, r + n, 0);
+    const SignedLimbs *coefficients[] = {&r0, &r1, &r2, &r3, &r4};
+    for (size_t i = 0; i < 5; ++i) {
+        const std::vector<limb_t> &c = coefficients[i]->mag;
+        if (!c.empty())
+            add_limbs(r + i * k, r + i * k, n - i * k, c.data(), c.size());
+    }
+}
+
+void multiply_toom3(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    toom3(r, a, an, b, bn, false);
+}
+
+void square_toom3(limb_t *r, const limb_t *a, size_t n) {
+    toom3(r, a, n, a, n, true);
+}
+
+// Products are computed on 32-bit digits modulo three primes of the form c * 2^k + 1 and recombined
+// with Garner's algorithm. Every convolution coefficient is below 2^25 * 2^64 < p0 * p1 * p2.
+static const uint64_t NTT_P0 = 2013265921, NTT_P1 = 1811939329, NTT_P2 = 2113929217;
+static const size_t NTT_MAX_LENGTH = (size_t) 1 << 25;
+static const int NTT_DIGIT_BITS = 32;
+static const int NTT_DIGITS_PER_LIMB = LIMB_BITS / NTT_DIGIT_BITS;
+
+static uint64_t power_modulo(uint64_t a, uint64_t e, uint64_t m) {
+    uint64_t result = 1;
+    a %= m;
+    while (e > 0) {
+        if (e & 1)
+            result = result * a % m;
+        a = a * a % m;
+        e >>= 1;
+    }
+    return result;
+}
+
+// the prime is a template argument so that every reduction compiles to multiplications
+template <uint64_t p, uint64_t root>
+static void ntt(std::vector<uint64_t> &v, bool invert) {
+    size_t n = v.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(v[i], v[j]);
+    }
+
+    std::vector<uint64_t> roots(n / 2);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        uint64_t w = power_modulo(root, (p - 1) / len, p);
+        if (invert)
+            w = power_modulo(w, p - 2, p);
+
+        size_t half = len / 2;
+        roots[0] = 1;
+        for (size_t j = 1; j < half; ++j)
+            roots[j] = roots[j - 1] * w % p;
+
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = v[i + j], t = v[i + j + half] * roots[j] % p;
+                v[i + j] = u + t < p ? u + t : u + t - p;
+                v[i + j + half] = u >= t ? u - t : u + p - t;
+            }
+        }
+    }
+
+    if (invert) {
+        uint64_t n_inverse = power_modulo(n, p - 2, p);
+        for (auto &x : v)
+            x = x * n_inverse % p;
+    }
+}
+
+static void split_digits(std::vector<uint64_t> &digits, const limb_t *a, size_t n, size_t length) {
+    digits.assign(length, 0);
+    for (size_t i = 0; i < n; ++i) {
+        digits[2 * i] = (uint32_t) a[i];
+        digits[2 * i + 1] = a[i] >> NTT_DIGIT_BITS;
+    }
+}
+
+// cyclic convolution of the digits of a and b modulo p, fb is scratch space
+template <uint64_t p, uint64_t root>
+static void convolve(std::vector<uint64_t> &fa, std::vector<uint64_t> &fb, const limb_t *a, size_t an,
+                     const limb_t *b, size_t bn, size_t length, bool square) {
+    split_digits(fa, a, an, length);
+    for (auto &x : fa)
+        x %= p;
+    ntt<p, root>(fa, false);
+    if (square) {
+        for (auto &x : fa)
+            x = x * x % p;
+    } else {
+        split_digits(fb, b, bn, length);
+        for (auto &x : fb)
+            x %= p;
+        ntt<p, root>(fb, false);
+        for (size_t i = 0; i < length; ++i)
+            fa[i] = fa[i] * fb[i] % p;
+    }
+    ntt<p, root>(fa, true);
+}
+
+static void ntt_product(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, bool square) {
+    size_t length = 1;
+    while (length < (an + bn) * NTT_DIGITS_PER_LIMB)
+        length <<= 1;
+
+    std::vector<uint64_t> x0, x1, x2, scratch;
+    convolve<NTT_P0, 31>(x0, scratch, a, an, b, bn, length, square);
+    convolve<NTT_P1, 13>(x1, scratch, a, an, b, bn, length, square);
+    convolve<NTT_P2, 5>(x2, scratch, a, an, b, bn, length, square);
+
+    // Garner: x = x0 + p0 * y1 + p0 * p1 * y2, then carry propagation over the digits
+    const uint64_t p0_inverse_p1 = power_modulo(NTT_P0, NTT_P1 - 2, NTT_P1);
+    const uint64_t p0_inverse_p2 = power_modulo(NTT_P0, NTT_P2 - 2, NTT_P2);
+    const uint64_t p1_inverse_p2 = power_modulo(NTT_P1, NTT_P2 - 2, NTT_P2);
+    const double_limb_t p0_p1 = (double_limb_t) NTT_P0 * NTT_P1;
+
+    double_limb_t carry = 0;
+    for (size_t i = 0; i < (an + bn) * NTT_DIGITS_PER_LIMB; ++i) {
+        uint64_t y1 = (x1[i] + NTT_P1 - x0[i] % NTT_P1) % NTT_P1 * p0_inverse_p1 % NTT_P1;
+        uint64_t y2 = (x2[i] + NTT_P2 - x0[i] % NTT_P2) % NTT_P2 * p0_inverse_p2 % NTT_P2;
+        y2 = (y2 + NTT_P2 - y1 % NTT_P2) % NTT_P2 * p1_inverse_p2 % NTT_P2;
+
+        carry += x0[i] + (double_limb_t) y1 * NTT_P0 + p0_p1 * y2;
+        if (i % 2 == 0)
+            r[i / 2] = (uint32_t) carry;
+        else
+            r[i / 2] |= (limb_t) (uint32_t) carry << NTT_DIGIT_BITS;
+        carry >>= NTT_DIGIT_BITS;
+    }
+}
+
+void multiply_ntt(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if ((an + bn) * NTT_DIGITS_PER_LIMB > NTT_MAX_LENGTH) {
+        multiply_toom3(r, a, an, b, bn);
+        return;
+    }
+    ntt_product(r, a, an, b, bn, false);
+}
+
+void square_ntt(limb_t *r, const limb_t *a, size_t n) {
+    if (2 * n * NTT_DIGITS_PER_LIMB > NTT_MAX_LENGTH) {
+        square_toom3(r, a, n);
+        return;
+    }
+    ntt_product(r, a, n, a, n, true);
+}
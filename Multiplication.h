@@ -0,0 +1,29 @@
+#pragma once
+
+#include "LimbMath.h"
+
+// Crossover points in limbs of the shorter operand. Below karatsuba the schoolbook loop is used,
+// from toom3 on Toom-Cook 3 and from ntt on the number theoretic transform.
+struct MultiplicationThresholds
+{
+	size_t karatsuba;
+	size_t karatsuba_square;
+	size_t toom3;
+	size_t ntt;
+};
+
+MultiplicationThresholds get_multiplication_thresholds();
+void set_multiplication_thresholds(const MultiplicationThresholds&); // safe to call while other threads multiply
+
+// r must not overlap a or b, all functions write an + bn (or 2n) limbs
+void multiply_limbs(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // picks the algorithm by size
+void square_limbs(limb_t* r, const limb_t* a, size_t n);
+
+// single algorithms, recursive subproducts go through multiply_limbs / square_limbs
+void square_schoolbook(limb_t* r, const limb_t* a, size_t n);
+void multiply_karatsuba(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+void square_karatsuba(limb_t* r, const limb_t* a, size_t n);
+void multiply_toom3(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn);
+void square_toom3(limb_t* r, const limb_t* a, size_t n);
+void multiply_ntt(limb_t* r, const limb_t* a, size_t an, const limb_t* b, size_t bn); // falls back to Toom-3 beyond 2^24 limbs in total
+void square_ntt(limb_t* r, const limb_t* a, size_t n);
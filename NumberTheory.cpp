@@ -1,83 +1,282 @@
 #include "NumberTheory.h"
-#include <map>
+#include "ModContext.h"
+#include "CRT.h"
+#include "DiscreteLog.h"
+#include "Division.h"
+#include "ECM.h"
+#include "Factorization.h"
+#include "FixedInt.h"
+#include "Instrumentation.h"
+#include "Primes.h"
+#include "SquareRoot.h"
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
 
-BigInt gcd(const BigInt& aa, const BigInt& bb)
+static std::atomic<unsigned> factorization_threads(0);
+static thread_local unsigned thread_factorization_threads = 0; // overrides factorization_threads if not 0
+
+static BigInt get_divider_escalating(const BigInt& n);
+
+// the residues of a ModContext or a FixedMontgomery, for the algorithms templated on either
+template<class Context>
+using Residue = std::remove_cvref_t<decltype(std::declval<const Context&>().get_one())>;
+
+// n clamped to 64 bits, as a bound for loops over primes
+static uint64_t to_prime_limit(const BigInt& n)
+{
+	auto limbs = n.get_limbs();
+	return n.get_sign() <= 0 ? 0 : limbs.size() > 1 ? UINT64_MAX : limbs[0];
+}
+
+// Stein's binary algorithm on words
+static limb_t binary_gcd(limb_t a, limb_t b)
 {
-	BigInt a(aa), b(bb);
-	while (a > 0 && b > 0)
+	if (a == 0 || b == 0)
+		return a | b;
+
+	int shift = count_trailing_zeros(a | b);
+	a >>= count_trailing_zeros(a);
+	while (b != 0)
 	{
+		b >>= count_trailing_zeros(b);
 		if (a > b)
-			a = a % b;
-		else
-			b = b % a;
+			std::swap(a, b);
+		b -= a;
 	}
 
-	return a > 0 ? a : b;
+	return a << shift;
 }
 
-BigInt extended_gcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y)
+// Matrix of one Lehmer step: the new a is A a + B b and the new b is C a + D b. A and B have opposite signs, as
+// have C and D. B = 0 means that a full division step was made instead.
+struct LehmerStep
+{
+	long long A, B, C, D;
+};
+
+// r = u a - v b for n-limb a and b when the difference is known to be non-negative, returns its normalized length
+static size_t combine_limbs(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t u, limb_t v)
+{
+	r[n] = multiply_limb(r, a, n, u);
+	r[n] -= subtract_multiply_limb(r, b, n, v);
+	return normalized_size(r, n + 1);
+}
+
+// Advances normalized magnitudes a >= b > 0 to later remainders of Euclid's sequence. Lehmer's algorithm (Knuth's
+// algorithm L) runs Euclid on the leading 62 bits while the quotients provably match the full ones, then applies the
+// collected word-sized matrix in one pass over the limbs. If no quotient could be confirmed, a is divided by b and
+// the quotient is left in q. Otherwise q and t are scratch space.
+static LehmerStep Euclid_step(std::vector<limb_t>& a, std::vector<limb_t>& b, std::vector<limb_t>& q,
+                              std::vector<limb_t>& t)
+{
+	size_t n = a.size(), bits = bit_length(a.data(), n), shift = bits > 62 ? bits - 62 : 0;
+	// leading bits and the corrections below stay within [0, 2^62], cofactors within 2^62 in absolute value
+	long long x = get_bits(a.data(), n, shift, 62), y = get_bits(b.data(), b.size(), shift, 62);
+	long long A = 1, B = 0, C = 0, D = 1;
+	while (y + C != 0 && y + D != 0)
+	{
+		long long quotient = (x + A) / (y + C);
+		if (quotient != (x + B) / (y + D))
+			break;
+
+		long long T = A - quotient * C;
+		A = C;
+		C = T;
+		T = B - quotient * D;
+		B = D;
+		D = T;
+		T = x - quotient * y;
+		x = y;
+		y = T;
+	}
+
+	if (B == 0)
+	{
+		q.resize(n - b.size() + 1);
+		t.resize(b.size());
+		divide_limbs(q.data(), t.data(), a.data(), n, b.data(), b.size());
+		q.resize(normalized_size(q.data(), q.size()));
+		t.resize(normalized_size(t.data(), t.size()));
+		a.swap(b);
+		b.swap(t);
+		return {1, 0, 0, 1};
+	}
+
+	b.resize(n, 0);
+	t.resize(n + 1);
+	q.resize(n + 1);
+	t.resize(B <= 0 ? combine_limbs(t.data(), a.data(), b.data(), n, A, -B)
+	                : combine_limbs(t.data(), b.data(), a.data(), n, B, -A));
+	q.resize(D <= 0 ? combine_limbs(q.data(), a.data(), b.data(), n, C, -D)
+	                : combine_limbs(q.data(), b.data(), a.data(), n, D, -C));
+	a.swap(t);
+	b.swap(q);
+	return {A, B, C, D};
+}
+
+static std::vector<limb_t> magnitude(const BigInt& a)
+{
+	auto limbs = a.get_limbs();
+	return std::vector<limb_t>(limbs.begin(), limbs.end());
+}
+
+BigInt gcd(const BigInt& aa, const BigInt& bb)
 {
-	if (a == 0)
+	INSTRUMENT_TIME("gcd");
+	INSTRUMENT_COUNT(GCD_CALLS, std::max(aa.get_number_of_limbs(), bb.get_number_of_limbs()));
+	// words take the binary gcd and stay inline
+	if (aa.get_number_of_limbs() <= 1 && bb.get_number_of_limbs() <= 1)
 	{
-		x = 0;
-		BigInt tmp = b;
-		y = tmp;
-		return b;
+		limb_t g = binary_gcd(aa == 0 ? 0 : aa.get_limbs()[0], bb == 0 ? 0 : bb.get_limbs()[0]);
+		return BigInt(std::span<const limb_t>(&g, 1), 1);
 	}
-	BigInt g = extended_gcd(b % a, a, x, y);
 
-	BigInt t = x;
-	x = y - b / a * x;
-	y = t;
+	std::vector<limb_t> a = magnitude(aa), b = magnitude(bb), q, t;
+	if (compare_limbs(a.data(), a.size(), b.data(), b.size()) < 0)
+		a.swap(b);
 
+	while (b.size() > 1)
+		Euclid_step(a, b, q, t);
+	if (b.empty())
+		return BigInt(a, 1);
+
+	limb_t g = binary_gcd(modulo_limb(a.data(), a.size(), b[0]), b[0]);
+	return BigInt(std::span<const limb_t>(&g, 1), 1);
+}
+
+BigInt extended_gcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y)
+{
+	INSTRUMENT_TIME("extended_gcd");
+	// Euclid on u = max(|a|, |b|) and v = min(|a|, |b|) keeps every remainder r = s |u| (mod v),
+	// the factor of v follows at the end
+	bool swapped = abs(a) < abs(b);
+	const BigInt& u = swapped ? b : a;
+	const BigInt& v = swapped ? a : b;
+	std::vector<limb_t> r0 = magnitude(u), r1 = magnitude(v), q, t;
+	BigInt s0 = 1, s1 = 0;
+
+	while (!r1.empty())
+	{
+		LehmerStep step = Euclid_step(r0, r1, q, t);
+		if (step.B == 0)
+		{
+			s0 -= BigInt(q, 1) * s1;
+			std::swap(s0, s1);
+		}
+		else
+		{
+			BigInt next = BigInt(step.C) * s0 + BigInt(step.D) * s1;
+			s0 = BigInt(step.A) * s0 + BigInt(step.B) * s1;
+			s1 = std::move(next);
+		}
+	}
+
+	BigInt g(r0, 1), u_factor = u.get_sign() < 0 ? -s0 : s0;
+	BigInt v_factor = v == 0 ? BigInt(0) : (g - u_factor * u) / v;
+	x = swapped ? v_factor : u_factor;
+	y = swapped ? u_factor : v_factor;
 	return g;
 }
 
+// a^(-1) mod m on fixed-width numbers for 0 <= a < m, 0 if there is none
+template<size_t Bits>
+static BigInt fixed_inverse_modulo(const BigInt& a, const BigInt& m)
+{
+	return inverse_modulo(FixedInt<Bits>(a), FixedInt<Bits>(m));
+}
+
 BigInt inverse_modulo(const BigInt& a, const BigInt& m)
 {
+	INSTRUMENT_TIME("inverse_modulo");
+	// an odd m of up to four limbs takes the binary algorithm on the stack, without a BigInt per step
+	if (m > 1 && (m.get_limbs()[0] & 1) != 0 && m.get_number_of_limbs() <= 4)
+	{
+		BigInt r = a % m;
+		if (r < 0)
+			r += m;
+		BigInt x = m.get_number_of_limbs() == 1 ? fixed_inverse_modulo<64>(r, m)
+			: m.get_number_of_limbs() == 2 ? fixed_inverse_modulo<128>(r, m) : fixed_inverse_modulo<256>(r, m);
+		if (x != 0)
+			return x;
+	}
+
 	// solve a * x + m * y = 1 with Euclidean algorithm
 	BigInt x, y;
 	extended_gcd(a, m, x, y);
+	x %= m;
 	if (x < 0)
-	{
-		x = x % m;
-		x = x + m;
-	}
-	x = x % m;
+		x += m;
 	return x;
 }
 
-BigInt CRTH(const std::vector<BigInt>& r, const std::vector<BigInt>& m)
+std::vector<BigInt> batch_inverse_modulo(const std::vector<BigInt>& a, const BigInt& m)
 {
-	BigInt MOD = 1;
-	for (int i = 0; i < m.size(); ++i)
-		MOD = MOD * m[i];
-
-	std::vector<BigInt> M(m.size());
+	INSTRUMENT_TIME("batch_inverse_modulo");
+	if (a.empty())
+		return {};
+
+	// Montgomery's trick: prefix[i] = a[0] * ... * a[i], one inversion of the full product, then every inverse is
+	// peeled off from the back
+	ModContext context(m);
+	std::vector<ModInt> values, prefix;
+	values.reserve(a.size());
+	prefix.reserve(a.size());
+	for (auto& x : a)
+	{
+		BigInt residue = x % m;
+		if (residue < 0)
+			residue += m;
+		values.emplace_back(context, residue);
+		prefix.push_back(prefix.empty() ? values.back() : prefix.back() * values.back());
+	}
 
-	for (int i = 0; i < m.size(); ++i)
-		M[i] = MOD / m[i];
+	BigInt x, y;
+	if (extended_gcd(prefix.back().to_BigInt(), m, x, y) != 1)
+		throw "NotInvertible";
+	if (x < 0)
+		x += m;
 
-	BigInt x;
-	for (int i = 0; i < m.size(); ++i)
-		x = x + M[i] * inverse_modulo(M[i], m[i]) * r[i];
+	std::vector<BigInt> result(a.size());
+	ModInt inverse(context, x);
+	for (size_t i = a.size() - 1; i > 0; --i)
+	{
+		result[i] = (inverse * prefix[i - 1]).to_BigInt();
+		inverse *= values[i];
+	}
+	result[0] = inverse.to_BigInt();
 
-	x = x % MOD;
+	return result;
+}
 
-	return x;
+BigInt CRTH(const std::vector<BigInt>& r, const std::vector<BigInt>& m)
+{
+	INSTRUMENT_TIME("CRTH");
+	return solve_congruences(r, m);
 }
 
 std::vector<BigInt> factorization_PollardRho(const BigInt& nn)
 {
+	INSTRUMENT_TIME("factorization_PollardRho");
 	if (nn < 100)
 		return factorization(nn);
 
 	std::vector<BigInt> res;
 	BigInt d, n(nn);
+	int exponent;
+	if (is_perfect_power(nn, &d, &exponent))
+	{
+		auto d_fact = factorization_PollardRho(d);
+		for (int i = 0; i < exponent; ++i)
+			res.insert(res.end(), d_fact.begin(), d_fact.end());
+		return res;
+	}
+
 	do
 	{
-		if (Miller_Rabin_test(n))
+		if (is_prime(n))
 		{
 			d = n;
 			res.push_back(d);
@@ -85,8 +284,8 @@ std::vector<BigInt> factorization_PollardRho(const BigInt& nn)
 		else
 		{
 
-			d = get_divider_PollardRho(n);
-			if (d != n && !Miller_Rabin_test(d))
+			d = get_divider_escalating(n);
+			if (d != n && !is_prime(d))
 			{
 				auto d_fact = factorization_PollardRho(d);
 				res.insert(res.end(), d_fact.begin(), d_fact.end());
@@ -94,7 +293,7 @@ std::vector<BigInt> factorization_PollardRho(const BigInt& nn)
 			else
 				res.push_back(d);
 		}
-		n = n / d;
+		n /= d;
 	} while (n != 1);
 
 	return res;
@@ -102,245 +301,627 @@ std::vector<BigInt> factorization_PollardRho(const BigInt& nn)
 
 std::vector<BigInt> factorization(const BigInt& nn)
 {
+	INSTRUMENT_TIME("factorization");
 	std::vector<BigInt> res;
 
 	BigInt n(nn);
 
-	for (int i = 2; i <= sqrt(n); ++i)
+	for (uint64_t p = 2; n > 1; )
 	{
-		while (n % i == 0)
+		p = find_small_divider(n, p, to_prime_limit(sqrt(n)));
+		if (p == 0)
+			break;
+
+		BigInt divider((long long) p);
+		do
 		{
-			res.push_back(i);
-			n = n / i;
-		}
+			res.push_back(divider);
+			n /= divider;
+		} while (find_small_divider(n, p, p) != 0);
 	}
 
 	if (n != 1) res.push_back(n);
 	return res;
 }
 
-BigInt get_divider_PollardRho(const BigInt& n)
+unsigned get_factorization_threads()
 {
-	//if (n < 100) return get_divider(n);
+	if (thread_factorization_threads != 0)
+		return thread_factorization_threads;
 
-	for (int i = 2; i < 100; ++i)
-		if (n % i == 0)
-			return i;
+	unsigned threads = factorization_threads.load(std::memory_order_relaxed);
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	return threads;
+}
 
-	srand(123);
-	BigInt x = rand() % n;
-	BigInt lambda = 10;
-	BigInt bound = sqrt(2 * lambda * sqrt(n)) + 1;  // iterations to obtain (1 - e^lambda) possibility of success
-	BigInt max_iter = (bound > 1e4 ? 1e4 : bound);
+void set_factorization_threads(unsigned threads)
+{
+	factorization_threads.store(threads, std::memory_order_relaxed);
+}
+
+void set_factorization_threads_of_this_thread(unsigned threads)
+{
+	thread_factorization_threads = threads;
+}
 
-	for (int i = 1; (1 << i) < max_iter; ++i)
+// Brent's cycle search on f(x) = x^2 + c. Products of |x - y| are accumulated and their gcd with n is taken
+// once per block. Returns n if the walk closed its cycle without splitting n or another worker set stop,
+// 1 if the cycle search went past max_steps (0 for no limit).
+template<class Context>
+static BigInt Pollard_Brent(const Context& context, const Residue<Context>& c, const Residue<Context>& seed,
+	const std::atomic<bool>& stop, long long max_steps)
+{
+	const int block = 128;
+	const BigInt& n = context.get_modulus();
+
+	Residue<Context> y = seed, x = seed, ys = seed, q = context.get_one();
+	BigInt g = 1;
+	for (long long r = 1; g == 1; r *= 2)
 	{
-		int cnt = (1 << i);
-		BigInt nx = x;
-		for (int j = 0; j < cnt; ++j)
+		if (max_steps != 0 && r > max_steps)
+			return 1;
+
+		x = y;
+		for (long long i = 0; i < r; ++i)
+			y.square(), y += c;
+		INSTRUMENT_ADD(RHO_ITERATIONS, context.get_size(), r);
+
+		for (long long k = 0; k < r && g == 1; k += block)
 		{
-			nx = (nx * nx + 1) % n; // f(x) = x^2 + 1
-			BigInt divider = gcd(abs(nx - x), n);
-			if (divider != 1 && divider != n)
-				return divider;
+			if (stop.load(std::memory_order_relaxed))
+				return n;
+
+			ys = y;
+			for (long long i = 0; i < std::min<long long>(block, r - k); ++i)
+			{
+				y.square(), y += c;
+				q *= x - y;
+			}
+			INSTRUMENT_ADD(RHO_ITERATIONS, context.get_size(), std::min<long long>(block, r - k));
+			// Montgomery form multiplies q by a unit, which does not change the gcd
+			g = gcd(q.to_BigInt(), n);
 		}
-		x = nx;
 	}
 
-	return n;
+	// the block overshot to a multiple of n, redo it one step at a time
+	if (g == n)
+		do
+		{
+			ys.square(), ys += c;
+			INSTRUMENT_COUNT(RHO_ITERATIONS, context.get_size());
+			g = gcd((x - ys).to_BigInt(), n);
+		} while (g == 1);
+
+	return g;
 }
 
-BigInt get_divider(const BigInt& n)
+// Races Pollard_Brent over the factorization threads, returns n if every worker went past max_steps
+static BigInt race_Pollard_Brent(const BigInt& n, long long max_steps)
 {
-	for (int i = 2; i <= sqrt(n); ++i)
-		if (n % i == 0)
-			return i;
+	// every worker walks its own polynomials from its own seeds, the first proper divider cancels the rest
+	std::atomic<bool> stop(false);
+	std::mutex result_mutex;
+	BigInt result = n;
+
+	with_modular_context(n, [&](const auto& context)
+	{
+		typedef Residue<std::remove_cvref_t<decltype(context)>> Value;
+		auto worker = [&](unsigned index, unsigned stride)
+		{
+			std::mt19937_64 rng(123 + index);
+			for (long long c = 1 + index; !stop.load(std::memory_order_relaxed); c += stride)
+			{
+				Value seed(context, BigInt((long long) (rng() >> 1)));
+				BigInt divider = Pollard_Brent(context, Value(context, c), seed, stop, max_steps);
+				if (divider == 1)
+					break;
+				if (divider != n)
+				{
+					std::lock_guard<std::mutex> lock(result_mutex);
+					if (!stop.exchange(true))
+						result = divider;
+				}
+			}
+		};
 
-	return n;
+		// spawning threads does not pay off on numbers that a single walk splits in microseconds
+		unsigned threads = n > (1LL << 40) ? get_factorization_threads() : 1;
+		if (threads == 1)
+			worker(0, 1);
+		else
+		{
+			std::vector<std::thread> pool;
+			for (unsigned i = 0; i < threads; ++i)
+				pool.emplace_back(worker, i, threads);
+			for (auto& thread : pool)
+				thread.join();
+		}
+	});
+
+	return result;
 }
 
-bool Miller_Rabin_test(const BigInt& n, int iterations_count)
+BigInt get_divider_PollardRho(const BigInt& n)
 {
-	if (n == 2) return true;
+	INSTRUMENT_TIME("get_divider_PollardRho");
+	if (uint64_t p = find_small_divider(n, 2, 100))
+		return BigInt((long long) p);
 
-	BigInt d = n - 1;
+	// a composite below 100^2 has a divider below 100
+	if (n < 100 * 100 || is_prime(n))
+		return n;
 
-	int s = 0;
-	while (d % 2 == 0)
-		d = d / 2, s++;
+	BigInt base;
+	if (is_perfect_power(n, &base))
+		return base;
 
-	// n - 1 = 2^s * d, d is odd
+	return race_Pollard_Brent(n, 0);
+}
 
-	for (int i = 0; i < iterations_count; ++i)
-	{
-		BigInt a = rand() % n;
+// for a composite n >= 100: rho while it finds dividers of up to about 12 digits quickly, then ECM
+// aiming at ever larger dividers. Returns n if even the largest ECM level failed. Both take time growing with the
+// smallest prime divider, which for a perfect power is as large as its root, so those are split by the root first.
+static BigInt get_divider_escalating(const BigInt& n)
+{
+	if (uint64_t p = find_small_divider(n, 2, 100))
+		return BigInt((long long) p);
 
-		if (a == 0) continue;
+	BigInt base;
+	if (is_perfect_power(n, &base))
+		return base;
 
-		BigInt t = big_pow_modulo(a, d, n);
-		if (t == 1)
-			continue;
+	BigInt d = race_Pollard_Brent(n, 1 << 18);
+	for (int digits = 15; d == n && digits <= 45; digits += 5)
+		d = get_divider_ECM(n, get_ECM_parameters(digits));
 
-		BigInt q = a;
-		bool flag = 0;
-		for (int r = 0; r < s; ++r)
-		{
-			if (big_pow_modulo(q, d, n) == n - 1)
-				flag = 1;
+	return d;
+}
 
-			q = q * q % n;
-		}
+BigInt get_divider(const BigInt& n)
+{
+	INSTRUMENT_TIME("get_divider");
+	uint64_t p = find_small_divider(n, 2, to_prime_limit(sqrt(n)));
+	return p != 0 ? BigInt((long long) p) : n;
+}
 
-		if (flag) continue;
+static uint64_t multiply_mod64(uint64_t a, uint64_t b, uint64_t n)
+{
+	return (uint64_t) ((double_limb_t) a * b % n);
+}
 
-		return false;
+static uint64_t pow_mod64(uint64_t a, uint64_t p, uint64_t n)
+{
+	uint64_t r = 1;
+	for (a %= n; p != 0; p >>= 1, a = multiply_mod64(a, a, n))
+		if (p & 1)
+			r = multiply_mod64(r, a, n);
+	return r;
+}
+
+// strong probable prime test to base a for an odd n > 2 with n - 1 = d * 2^s, a multiple of n passes
+static bool strong_probable_prime64(uint64_t n, uint64_t d, int s, uint64_t a)
+{
+	INSTRUMENT_COUNT(MILLER_RABIN_ROUNDS, 1);
+	uint64_t x = pow_mod64(a, d, n);
+	if (x == 0 || x == 1 || x == n - 1)
+		return true;
+
+	for (int r = 1; r < s; ++r)
+	{
+		x = multiply_mod64(x, x, n);
+		if (x == n - 1)
+			return true;
 	}
 
-	return true;
+	return false;
 }
 
-BigInt discrete_logarithm(const BigInt& a, const BigInt& b, const BigInt& m)
+// the same for a multi-limb n, a < 2^63
+template<class Context>
+static bool strong_probable_prime(const Context& context, const BigInt& d, int s, uint64_t a)
 {
-	if (gcd(a, m) != 1)
-		throw "AAndMHaveCommonDividers";
+	INSTRUMENT_COUNT(MILLER_RABIN_ROUNDS, context.get_size());
+	Residue<Context> one = context.get_one(), minus_one = Residue<Context>(context, 0) - one;
+	Residue<Context> x = context.pow(Residue<Context>(context, BigInt((long long) a)), d);
+	if (x.is_zero() || x == one || x == minus_one)
+		return true;
 
-	BigInt n = sqrt(m) + 1;
-	std::map<BigInt, BigInt> vals;
-	BigInt t = 0, np1 = n + 1;
-	for (BigInt i = 1; i != np1; i = i + 1)
+	for (int r = 1; r < s; ++r)
 	{
-		t = t + n;
-		vals[big_pow_modulo(a, t, m)] = i;
+		x.square();
+		if (x == minus_one)
+			return true;
 	}
-	for (int i = 0; i <= n; ++i) {
-		BigInt cur = (big_pow_modulo(a, i, m) * b) % m;
-		if (vals.count(cur)) {
-			BigInt ans = vals[cur] * n - i;
-			if (ans < m)
-				return ans;
-		}
+
+	return false;
+}
+
+static const uint32_t FIRST_PRIMES[] = {
+	2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97};
+
+bool Miller_Rabin_test(const BigInt& n, int iterations_count)
+{
+	INSTRUMENT_TIME("Miller_Rabin_test");
+	if (n < 3) return n == 2;
+	if ((n.get_limbs()[0] & 1) == 0) return false;
+
+	// n - 1 = 2^s * d, d is odd, the bases are the first primes
+	BigInt d = n - 1;
+	int s = 0;
+	while ((d.get_limbs()[0] & 1) == 0)
+		d >>= 1, s++;
+
+	// a constant table covers the usual counts, the shared prime table the rest
+	std::shared_ptr<const PrimeTable> table;
+	if (iterations_count > (int) std::size(FIRST_PRIMES))
+		table = get_primes(nth_prime(iterations_count));
+	auto base = [&](int i) { return table ? (*table)[i] : FIRST_PRIMES[i]; };
+
+	if (n.get_number_of_limbs() == 1)
+	{
+		for (int i = 0; i < iterations_count; ++i)
+			if (!strong_probable_prime64(n.get_limbs()[0], d.get_limbs()[0], s, base(i)))
+				return false;
+		return true;
 	}
-	return -1;
+
+	return with_modular_context(n, [&](const auto& context)
+	{
+		for (int i = 0; i < iterations_count; ++i)
+			if (!strong_probable_prime(context, d, s, base(i)))
+				return false;
+		return true;
+	});
 }
 
-BigInt Euler_function(const BigInt& n)
+// result times (x / m) for odd m by binary reciprocity: factors of 2 are shifted out of x, then the larger of the two
+// odd numbers is replaced by their difference
+static int Jacobi_word(uint64_t x, uint64_t m, int result)
 {
-	auto r = factorization_PollardRho(n);
-	sort(r.begin(), r.end());
+	while (x != 0)
+	{
+		int zeros = count_trailing_zeros(x);
+		x >>= zeros;
+		if ((zeros & 1) && ((m & 7) == 3 || (m & 7) == 5))
+			result = -result;
+		if (x < m)
+		{
+			std::swap(x, m);
+			if ((x & 3) == 3 && (m & 3) == 3)
+				result = -result;
+		}
+		x -= m;
+	}
 
-	std::vector<std::pair<BigInt, int>> nr;
+	return m == 1 ? result : 0;
+}
 
-	int cnt = 0;
-	for (int i = 0; i < r.size(); ++i)
+// (a / n) for magnitudes a < n and odd n, the same steps on limbs until n fits a word
+static int Jacobi_limbs(std::vector<limb_t> a, std::vector<limb_t> n)
+{
+	int result = 1;
+	while (n.size() > 1)
 	{
-		cnt++;
-		if (i == r.size() - 1 || r[i] != r[i + 1])
+		if (a.empty())
+			return 0;
+
+		size_t zero_limbs = 0;
+		while (a[zero_limbs] == 0)
+			++zero_limbs;
+		int zeros = count_trailing_zeros(a[zero_limbs]);
+		a.erase(a.begin(), a.begin() + zero_limbs);
+		shift_right_limbs(a.data(), a.data(), a.size(), zeros);
+		a.resize(normalized_size(a.data(), a.size()));
+		// whole limbs are an even number of factors of 2
+		if ((zeros & 1) && ((n[0] & 7) == 3 || (n[0] & 7) == 5))
+			result = -result;
+
+		if (compare_limbs(a.data(), a.size(), n.data(), n.size()) < 0)
 		{
-			nr.push_back(std::make_pair(r[i], cnt));
-			cnt = 0;
+			a.swap(n);
+			if ((a[0] & 3) == 3 && (n[0] & 3) == 3)
+				result = -result;
 		}
+		subtract_limbs(a.data(), a.data(), a.size(), n.data(), n.size());
+		a.resize(normalized_size(a.data(), a.size()));
 	}
-	BigInt ans = 1;
-	for (auto p : nr)
-		ans = ans * big_pow(p.first, p.second - 1) * (p.first - 1);
 
-	return ans;
+	return Jacobi_word(modulo_limb(a.data(), a.size(), n[0]), n[0], result);
 }
 
-BigInt Mobius_function(const BigInt& n)
+// (a / n) for a small a and an odd n > 0, by quadratic reciprocity on n modulo |a|
+static int Jacobi_small(long long a, const BigInt& n)
 {
-	auto r = factorization_PollardRho(n);
-	sort(r.begin(), r.end());
+	limb_t low = n.get_limbs()[0];
+	int result = 1;
+	if (a < 0)
+	{
+		a = -a;
+		if ((low & 3) == 3)
+			result = -result;
+	}
+	for (; a % 2 == 0; a /= 2)
+		if ((low & 7) == 3 || (low & 7) == 5)
+			result = -result;
+	if ((a & 3) == 3 && (low & 3) == 3)
+		result = -result;
 
-	std::vector<std::pair<BigInt, int>> nr;
+	return Jacobi_word(modulo_limb(n.get_limbs().data(), n.get_number_of_limbs(), a), a, result);
+}
 
-	int cnt = 0;
-	for (int i = 0; i < r.size(); ++i)
+// the strong Lucas test of the modulus n with P = 1 and Q = (1 - D) / 4, n + 1 = 2^s * d for an odd d
+template<class Context>
+static bool strong_Lucas_sequences(const Context& context, long long D, const BigInt& d, int s)
+{
+	// U_k, V_k and Q^k with P = 1 from k = 1, doubling k and adding one by the bits of d
+	typedef Residue<Context> Value;
+	Value one = context.get_one(), D_mod(context, D), Q(context, (1 - D) / 4);
+	Value U = one, V = one, Qk = Q;
+	auto bits = d.get_limbs();
+	for (size_t i = bit_length(bits.data(), bits.size()) - 1; i-- > 0;)
 	{
-		cnt++;
-		if (i == r.size() - 1 || r[i] != r[i + 1])
+		U *= V;
+		V.square();
+		V -= Qk;
+		V -= Qk;
+		Qk.square();
+
+		if (get_bits(bits.data(), bits.size(), i, 1))
 		{
-			nr.push_back(std::make_pair(r[i], cnt));
-			cnt = 0;
+			Value U_next = U + V;
+			V = D_mod * U + V;
+			U = U_next.halve();
+			V.halve();
+			Qk *= Q;
 		}
 	}
 
-	for (auto p : nr)
-		if (p.second > 1) return 0;
+	if (U.is_zero() || V.is_zero())
+		return true;
 
-	return ((nr.size() & 1) == 1 ? -1 : 1);
+	for (int r = 1; r < s; ++r)
+	{
+		V.square();
+		V -= Qk;
+		V -= Qk;
+		Qk.square();
+		if (V.is_zero())
+			return true;
+	}
+
+	return false;
 }
 
-int Legendre_symbol(const BigInt& n, const BigInt& p)
+// strong Lucas probable prime test with Selfridge's parameters, n odd and without dividers below 1000
+static bool strong_Lucas_probable_prime(const BigInt& n)
 {
-	if (p == 2 || !Miller_Rabin_test(p))
-		throw "PIsNotPrime";
+	// first D of 5, -7, 9, -11, ... with (D / n) = -1, such D never appears for a perfect square
+	long long D = 5;
+	for (int tries = 0; ; ++tries, D = D > 0 ? -D - 2 : -D + 2)
+	{
+		int symbol = Jacobi_small(D, n);
+		if (symbol == -1)
+			break;
+		if (symbol == 0)
+			return false;
+		if (tries == 8 && is_perfect_square(n))
+			return false;
+	}
 
-	if (n % p == 0)
-		return 0;
+	// n + 1 = 2^s * d, d is odd
+	BigInt d = n + 1;
+	int s = 0;
+	while ((d.get_limbs()[0] & 1) == 0)
+		d >>= 1, s++;
 
-	return (big_pow_modulo(n % p, (p - 1) / 2, p) == 1 ? 1 : -1);
+	return with_modular_context(n, [&](const auto& context) { return strong_Lucas_sequences(context, D, d, s); });
 }
 
-int Jacobi_symbol(const BigInt& n, const BigInt& p)
+bool is_prime(const BigInt& n)
 {
-	if (p % 2 != 1)
-		throw "PIsNotOdd";
+	INSTRUMENT_TIME("is_prime");
+	if (n < 2) return false;
 
-	auto r = factorization_PollardRho(p);
-	sort(r.begin(), r.end());
+	if (uint64_t p = find_small_divider(n, 2, 1000))
+		return n == BigInt((long long) p);
+	if (n < 1000 * 1000)
+		return true;
 
-	std::vector<std::pair<BigInt, int>> nr;
+	BigInt d = n - 1;
+	int s = 0;
+	while ((d.get_limbs()[0] & 1) == 0)
+		d >>= 1, s++;
 
-	int cnt = 0;
-	for (int i = 0; i < r.size(); ++i)
+	// these seven bases leave no strong pseudoprime below 2^64
+	if (n.get_number_of_limbs() == 1)
 	{
-		cnt++;
-		if (i == r.size() - 1 || r[i] != r[i + 1])
-		{
-			nr.push_back(std::make_pair(r[i], cnt));
-			cnt = 0;
-		}
+		for (uint64_t a : {2, 325, 9375, 28178, 450775, 9780504, 1795265022})
+			if (!strong_probable_prime64(n.get_limbs()[0], d.get_limbs()[0], s, a))
+				return false;
+		return true;
 	}
 
-	int ans = 1;
+	// Baillie-PSW, no composite is known to pass it
+	auto base_2 = [&](const auto& context) { return strong_probable_prime(context, d, s, 2); };
+	return with_modular_context(n, base_2) && strong_Lucas_probable_prime(n);
+}
 
-	for (auto t : nr)
+// whether n = r^p for a prime p >= 3. A p-th power is 0 or a p-th power residue modulo every prime q = 1 (mod p),
+// and for an even n its number of trailing zero bits is a multiple of p. A few such q from the prime table reject
+// almost all other n before the root is taken.
+static bool is_prime_power_of(const BigInt& n, int p, const PrimeTable& primes, BigInt& r)
+{
+	auto limbs = n.get_limbs();
+	if ((limbs[0] & 1) == 0)
 	{
-		if (t.second & 1)
-			ans *= Legendre_symbol(n, t.first);
+		size_t zeros = 0;
+		while (limbs[zeros / LIMB_BITS] == 0)
+			zeros += LIMB_BITS;
+		zeros += count_trailing_zeros(limbs[zeros / LIMB_BITS]);
+		if (zeros % p != 0)
+			return false;
 	}
 
-	return ans;
+	int filters = 0;
+	for (uint64_t q = 2 * p + 1; filters < 4 && q <= primes.back(); q += 2 * p)
+		if (std::binary_search(primes.begin(), primes.end(), q))
+		{
+			++filters;
+			uint64_t residue = modulo_limb(limbs.data(), limbs.size(), q);
+			if (residue != 0 && pow_mod64(residue, (q - 1) / p, q) != 1)
+				return false;
+		}
+
+	r = root(n, p);
+	return big_pow(r, p) == n;
 }
 
-BigInt discrete_sqrt(const BigInt& b, const BigInt& m)
+bool is_perfect_power(const BigInt& n, BigInt* base, int* exponent)
 {
-	BigInt a = rand() % m;
-	while (Legendre_symbol((a * a - b + m) % m, m) != -1)
-		a = rand() % m;
+	INSTRUMENT_TIME("is_perfect_power");
+	if (n < 4)
+		return false;
 
-	BigInt t = (a * a - b + m) % m;
+	BigInt b = n, r;
+	int e = 1;
+	while (is_perfect_square(b, &r))
+		b = std::move(r), e *= 2;
+
+	// strip odd prime exponents one at a time, r^p has at least p + 1 bits. The filter primes 2 k p + 1 of the
+	// largest p stay below 256 p for all but very few p.
+	size_t bits = bit_length(b.get_limbs().data(), b.get_number_of_limbs());
+	auto primes = get_primes(256 * bits);
+	for (auto it = primes->begin() + 1; it != primes->end() && *it < bits; ++it)
+		while (is_prime_power_of(b, *it, *primes, r))
+		{
+			b = std::move(r), e *= *it;
+			bits = bit_length(b.get_limbs().data(), b.get_number_of_limbs());
+		}
 
-	BigInt x; // x = (a + sqrt(a * a - n))^((m + 1) / 2)
+	if (e == 1)
+		return false;
+	if (base)
+		*base = std::move(b);
+	if (exponent)
+		*exponent = e;
+	return true;
+}
 
-	BigInt d = (m + 1) / 2;
+BigInt discrete_logarithm(const BigInt& a, const BigInt& b, const BigInt& m)
+{
+	INSTRUMENT_TIME("discrete_logarithm");
+	if (gcd(a, m) != 1)
+		throw "AAndMHaveCommonDividers";
 
-	std::pair<BigInt, BigInt> p(1, 0);
-	std::pair<BigInt, BigInt> k(a, 1);
+	// (Z/m)^* is the product of the groups modulo the prime powers of m, which are cyclic for odd primes. x is found
+	// modulo the order of a in each of them and the congruences are combined, they may contradict each other.
+	std::vector<BigInt> residues, orders;
+	for (auto& p : factorize(m))
+	{
+		BigInt q = big_pow(p.prime, p.exponent);
+		ModContext context(q);
+		ModInt g(context, (a % q + q) % q), h(context, (b % q + q) % q), one = context.get_one();
+
+		// the group has order p^(e - 1) (p - 1), the factors that g does not need are divided out
+		BigInt order = q / p.prime * (p.prime - 1);
+		Factorization order_factors = factorize(p.prime - 1);
+		if (p.exponent > 1)
+		{
+			order_factors.push_back({p.prime, p.exponent - 1});
+			std::sort(order_factors.begin(), order_factors.end(), [](auto& x, auto& y) { return x.prime < y.prime; });
+		}
+		for (auto& f : order_factors)
+			while (f.exponent > 0 && context.pow(g, order / f.prime) == one)
+				order /= f.prime, f.exponent--;
+		std::erase_if(order_factors, [](auto& f) { return f.exponent == 0; });
+
+		BigInt x = discrete_logarithm_Pohlig_Hellman(g, h, order, order_factors);
+		if (x < 0)
+			return -1;
+		residues.push_back(x);
+		orders.push_back(order);
+	}
 
-	while (d != 0)
+	try
 	{
-		if (d % 2 == 1)
-			p = std::make_pair((k.first * p.first + t * k.second * p.second) % m, (k.first * p.second + k.second * p.first) % m);
+		return solve_congruences(residues, orders);
+	}
+	catch (const char*)
+	{
+		return -1;
+	}
+}
+
+BigInt Euler_function(const BigInt& n)
+{
+	INSTRUMENT_TIME("Euler_function");
+	BigInt ans = 1;
+	for (auto& p : factorize(n))
+		ans *= big_pow(p.prime, p.exponent - 1) * (p.prime - 1);
+
+	return ans;
+}
+
+BigInt Mobius_function(const BigInt& n)
+{
+	INSTRUMENT_TIME("Mobius_function");
+	auto factors = factorize(n);
+	for (auto& p : factors)
+		if (p.exponent > 1) return 0;
+
+	return ((factors.size() & 1) == 1 ? -1 : 1);
+}
 
-		d = d / 2;
+int Legendre_symbol(const BigInt& n, const BigInt& p, bool p_is_prime)
+{
+	INSTRUMENT_TIME("Legendre_symbol");
+	if (p == 2 || (!p_is_prime && !is_prime(p)))
+		throw "PIsNotPrime";
+
+	return Jacobi_symbol(n, p);
+}
 
-		k = std::make_pair((k.first * k.first + t * k.second * k.second) % m, 2 * k.first * k.second % m);
+int Jacobi_symbol(const BigInt& n, const BigInt& p)
+{
+	INSTRUMENT_TIME("Jacobi_symbol");
+	if (p % 2 != 1)
+		throw "PIsNotOdd";
+
+	BigInt a = n % p;
+	if (a < 0)
+		a += p;
+	return Jacobi_limbs(magnitude(a), magnitude(p));
+}
+
+int Kronecker_symbol(const BigInt& a, const BigInt& n)
+{
+	INSTRUMENT_TIME("Kronecker_symbol");
+	if (n == 0)
+		return abs(a) == 1 ? 1 : 0;
+
+	// (a / -1) is the sign of a, (a / 2) is 0 for even a and otherwise 1 or -1 as a is +-1 or +-3 modulo 8
+	int result = n < 0 && a < 0 ? -1 : 1;
+	BigInt m = abs(n);
+	int zeros = 0;
+	for (auto limbs = m.get_limbs(); limbs[zeros / LIMB_BITS] == 0;)
+		zeros += LIMB_BITS;
+	zeros += count_trailing_zeros(m.get_limbs()[zeros / LIMB_BITS]);
+	if (zeros > 0)
+	{
+		if (a % 2 == 0)
+			return 0;
+		m >>= zeros;
+		BigInt r = (a % 8 + 8) % 8;
+		if ((zeros & 1) && (r == 3 || r == 5))
+			result = -result;
 	}
 
-	if (p.second != 0)
-		throw "Error";
+	return result * Jacobi_symbol(a, m);
+}
 
-	return p.first;
-}
\ No newline at end of file
+BigInt discrete_sqrt(const BigInt& b, const BigInt& m)
+{
+	INSTRUMENT_TIME("discrete_sqrt");
+	return SquareRootContext(m).root(b);
+}
@@ -5,15 +5,24 @@
 BigInt gcd(const BigInt&, const BigInt&);
 BigInt extended_gcd(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y); //find x and y, so that a * x + b * y = gcd(a, b)
 BigInt inverse_modulo(const BigInt& a, const BigInt& mod);
-BigInt CRTH(const std::vector<BigInt>& a, const std::vector<BigInt>& m); //using Chinese remainder theorem for solving x = a[i] (mod m[i])
-std::vector<BigInt> factorization_PollardRho(const BigInt&);
+// inverses of every a[i] modulo m > 0 with one inversion and 3 (n - 1) multiplications, throws "NotInvertible" if
+// some a[i] shares a divider with m
+std::vector<BigInt> batch_inverse_modulo(const std::vector<BigInt>& a, const BigInt& m);
+BigInt CRTH(const std::vector<BigInt>& a, const std::vector<BigInt>& m); // x = a[i] (mod m[i]) in [0, lcm), see solve_congruences
+std::vector<BigInt> factorization_PollardRho(const BigInt&); // escalates from Pollard rho to ECM when rho stalls
 std::vector<BigInt> factorization(const BigInt&);
-BigInt get_divider_PollardRho(const BigInt& n); // returns n if not trivial divider wasn't found
+BigInt get_divider_PollardRho(const BigInt& n); // returns n if n is prime, Brent's rho raced over get_factorization_threads() threads
+unsigned get_factorization_threads();
+void set_factorization_threads(unsigned); // 0 uses every hardware thread
+void set_factorization_threads_of_this_thread(unsigned); // overrides the setting on the calling thread, 0 restores it
 BigInt get_divider(const BigInt& n); // returns n if not trivial divider wasn't found
-bool Miller_Rabin_test(const BigInt& n, int iterations_count = 3);
-BigInt discrete_logarithm(const BigInt& a, const BigInt& b, const BigInt& m); // a^x = b (mod m) baby-step-giant-step-algorithm
-BigInt Euler_function(const BigInt&);
+bool Miller_Rabin_test(const BigInt& n, int iterations_count = 3); // strong tests to the first iterations_count prime bases
+bool is_prime(const BigInt& n); // deterministic below 2^64, Baillie-PSW above
+bool is_perfect_power(const BigInt& n, BigInt* base = nullptr, int* exponent = nullptr); // n = base^exponent, the largest exponent > 1
+BigInt discrete_logarithm(const BigInt& a, const BigInt& b, const BigInt& m); // smallest x >= 0 with a^x = b (mod m) or -1, Pohlig-Hellman over the prime powers of m
+BigInt Euler_function(const BigInt&); // n >= 1, factorizations come from the cache of factorize
 BigInt Mobius_function(const BigInt&);
-int Legendre_symbol(const BigInt& n, const BigInt& p);
-int Jacobi_symbol(const BigInt& n, const BigInt& p);
-BigInt discrete_sqrt(const BigInt& b, const BigInt& m); // x^2 = b (mod m)
\ No newline at end of file
+int Legendre_symbol(const BigInt& n, const BigInt& p, bool p_is_prime = false); // skips the primality test of p if the caller knows
+int Jacobi_symbol(const BigInt& n, const BigInt& p); // p odd and positive, binary reciprocity without factoring p
+int Kronecker_symbol(const BigInt& a, const BigInt& n); // any n
+BigInt discrete_sqrt(const BigInt& b, const BigInt& m); // some x with x^2 = b (mod m) for m > 0, -1 if there is none, see SquareRootContext
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include "Primes.h"
+
+// Numbers coprime to 30 keep one bit each, so a byte covers 30 consecutive numbers.
+static const uint64_t WHEEL[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+static const uint64_t WHEEL_GAPS[8] = {6, 4, 2, 4, 2, 4, 6, 2};
+static const int WHEEL_BIT[30] = {-1, 0, -1, -1, -1, -1, -1, 1, -1, -1, -1, 2, -1, 3, -1, -1, -1, 4, -1, 5, -1, -1,
+                                  -1, 6, -1, -1, -1, -1, -1, 7};
+static const int NEXT_WHEEL_INDEX[30] = {0, 0, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 4, 4, 4, 4, 5, 5, 6, 6, 6, 6,
+                                         7, 7, 7, 7, 7, 7};
+
+static const size_t SEGMENT_BYTES = 32768;
+static const uint64_t BOOTSTRAP_LIMIT = 30 * 2185; // primes up to its square root are found by trial division
+
+static std::mutex table_mutex;
+static std::shared_ptr<const PrimeTable> table; // every prime below table_limit, guarded by table_mutex
+static uint64_t table_limit = 0;
+
+// Sieves [low, low + 30 * size) for a multiple of 30 low. base must hold every prime up to the square root of the end.
+static void sieve_segment(uint8_t *bits, size_t size, uint64_t low, const PrimeTable &base) {
+    std::fill(bits, bits + size, 0xFF);
+    if (low == 0)
+        bits[0] &= ~1; // 1 is not a prime
+
+    uint64_t high = low + 30 * size;
+    for (uint32_t p : base) {
+        if (p < 7)
+            continue;
+        if ((uint64_t) p * p >= high)
+            break;
+
+        // p * k for k coprime to 30 from max(p, low / p) on, smaller multiples belong to smaller primes
+        uint64_t k = std::max<uint64_t>(p, (low + p - 1) / p);
+        int w = NEXT_WHEEL_INDEX[k % 30];
+        k += WHEEL[w] - k % 30;
+        for (uint64_t m = p * k; m < high; m += p * WHEEL_GAPS[w], w = (w + 1) & 7) {
+            uint64_t offset = m - low;
+            bits[offset / 30] &= ~(1 << WHEEL_BIT[offset % 30]);
+        }
+    }
+}
+
+static void append_primes(PrimeTable &primes, const uint8_t *bits, size_t size, uint64_t low) {
+    for (size_t i = 0; i < size; ++i)
+        for (unsigned b = bits[i]; b != 0; b &= b - 1)
+            primes.push_back((uint32_t) (low + 30 * i + WHEEL[count_trailing_zeros(b)]));
+}
+
+std::shared_ptr<const PrimeTable> get_primes(uint64_t limit) {
+    limit = std::min(limit, MAX_PRIME_TABLE_LIMIT);
+
+    std::lock_guard<std::mutex> lock(table_mutex);
+    if (table_limit > limit)
+        return table;
+
+    std::vector<uint8_t> bits(SEGMENT_BYTES);
+    if (!table) {
+        PrimeTable base;
+        for (uint32_t i = 2; i * i < BOOTSTRAP_LIMIT; ++i)
+            if (std::none_of(base.begin(), base.end(), [i](uint32_t p) { return i % p == 0; }))
+                base.push_back(i);
+
+        auto primes = std::make_shared<PrimeTable>(PrimeTable{2, 3, 5});
+        sieve_segment(bits.data(), BOOTSTRAP_LIMIT / 30, 0, base);
+        append_primes(*primes, bits.data(), BOOTSTRAP_LIMIT / 30, 0);
+        table = primes;
+        table_limit = BOOTSTRAP_LIMIT;
+    }
+
+    // at least double, so that a slowly rising limit costs amortized linear time. The bootstrap table is enough
+    // as the base: its square exceeds MAX_PRIME_TABLE_LIMIT.
+    if (table_limit <= limit) {
+        uint64_t new_limit = std::max(limit + 1, 2 * table_limit);
+        new_limit = std::min(new_limit, MAX_PRIME_TABLE_LIMIT + 1);
+        new_limit = (new_limit + 29) / 30 * 30;
+
+        auto primes = std::make_shared<PrimeTable>(*table);
+        for (uint64_t low = table_limit; low < new_limit; low += 30 * SEGMENT_BYTES) {
+            size_t size = std::min<uint64_t>(SEGMENT_BYTES, (new_limit - low) / 30);
+            sieve_segment(bits.data(), size, low, *table);
+            append_primes(*primes, bits.data(), size, low);
+        }
+        table = primes;
+        table_limit = new_limit;
+    }
+
+    return table;
+}
+
+PrimeIterator::PrimeIterator(uint64_t start) : low(start / 30 * 30), byte(0), start(start) {
+    sieve_next_segment();
+    for (int i = 0; i < 8; ++i)
+        if (low + WHEEL[i] < start)
+            segment[0] &= ~(1 << i);
+}
+
+void PrimeIterator::sieve_next_segment() {
+    uint64_t high = low + 30 * SEGMENT_BYTES;
+    auto base = get_primes((uint64_t) std::sqrt((double) high) + 1);
+
+    segment.resize(SEGMENT_BYTES);
+    sieve_segment(segment.data(), SEGMENT_BYTES, low, *base);
+    byte = 0;
+}
+
+uint64_t PrimeIterator::next() {
+    // 2, 3 and 5 are not on the wheel
+    for (uint64_t p : {2, 3, 5})
+        if (start <= p) {
+            start = p + 1;
+            return p;
+        }
+
+    while (true) {
+        for (; byte < segment.size(); ++byte)
+            if (segment[byte] != 0) {
+                int i = count_trailing_zeros(segment[byte]);
+                segment[byte] &= segment[byte] - 1;
+                return low + 30 * byte + WHEEL[i];
+            }
+
+        low += 30 * segment.size();
+        sieve_next_segment();
+    }
+}
+
+// Counts segment by segment from the end of the full table, stops after the segment where the count exceeds stop_count
+// or the numbers exceed x. Returns the count of primes <= x, or the nth prime for stop_count = n.
+static uint64_t sieve_beyond_table(uint64_t x, uint64_t stop_count, bool return_prime) {
+    auto primes = get_primes(MAX_PRIME_TABLE_LIMIT);
+    uint64_t low = MAX_PRIME_TABLE_LIMIT / 30 * 30;
+    uint64_t count = std::lower_bound(primes->begin(), primes->end(), low) - primes->begin();
+
+    std::vector<uint8_t> bits(SEGMENT_BYTES);
+    for (;; low += 30 * SEGMENT_BYTES) {
+        uint64_t high = low + 30 * SEGMENT_BYTES;
+        sieve_segment(bits.data(), SEGMENT_BYTES, low, *get_primes((uint64_t) std::sqrt((double) high) + 1));
+
+        for (size_t i = 0; i < SEGMENT_BYTES; ++i)
+            for (unsigned b = bits[i]; b != 0; b &= b - 1) {
+                uint64_t p = low + 30 * i + WHEEL[count_trailing_zeros(b)];
+                if (!return_prime && p > x)
+                    return count;
+                if (++count == stop_count && return_prime)
+                    return p;
+            }
+    }
+}
+
+uint64_t prime_pi(uint64_t x) {
+    if (x <= MAX_PRIME_TABLE_LIMIT) {
+        auto primes = get_primes(x);
+        return std::upper_bound(primes->begin(), primes->end(), x) - primes->begin();
+    }
+
+    return sieve_beyond_table(x, 0, false);
+}
+
+uint64_t nth_prime(uint64_t n) {
+    if (n == 0) throw "PrimeIndexIsZero";
+
+    // p_n < n (ln n + ln ln n) for n >= 6
+    double estimate = n < 6 ? 13 : n * (std::log((double) n) + std::log(std::log((double) n)));
+    auto primes = get_primes((uint64_t) std::min<double>(estimate, MAX_PRIME_TABLE_LIMIT));
+    if (primes->size() >= n)
+        return (*primes)[n - 1];
+
+    return sieve_beyond_table(0, n, true);
+}
+
+uint64_t find_small_divider(const BigInt &n, uint64_t from, uint64_t to) {
+    auto limbs = n.get_limbs();
+    std::vector<uint64_t> group;
+    limb_t product = 1;
+
+    auto flush = [&]() -> uint64_t {
+        limb_t remainder = modulo_limb(limbs.data(), limbs.size(), product);
+        for (uint64_t p : group)
+            if (remainder % p == 0)
+                return p;
+
+        group.clear();
+        product = 1;
+        return 0;
+    };
+
+    auto offer = [&](uint64_t p) -> uint64_t {
+        uint64_t divider = 0;
+        if (product > UINT64_MAX / p)
+            divider = flush();
+        group.push_back(p);
+        product *= p;
+        return divider;
+    };
+
+    uint64_t divider = 0;
+    auto primes = get_primes(std::min(to, MAX_PRIME_TABLE_LIMIT));
+    for (auto it = std::lower_bound(primes->begin(), primes->end(), from);
+         divider == 0 && it != primes->end() && *it <= to && *it <= MAX_PRIME_TABLE_LIMIT; ++it)
+        divider = offer(*it);
+
+    if (divider == 0 && to > MAX_PRIME_TABLE_LIMIT) {
+        PrimeIterator it(std::max(from, MAX_PRIME_TABLE_LIMIT + 1));
+        for (uint64_t p = it.next(); divider == 0 && p <= to; p = it.next())
+            divider = offer(p);
+    }
+
+    return divider != 0 || group.empty() ? divider : flush();
+}
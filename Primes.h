@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BigInt.h"
+
+// Process-wide table of the primes up to some limit, grown on demand by a segmented sieve and shared between threads.
+// A returned table never changes, growing publishes a longer copy.
+typedef std::vector<uint32_t> PrimeTable;
+
+const uint64_t MAX_PRIME_TABLE_LIMIT = 1 << 26;
+
+std::shared_ptr<const PrimeTable> get_primes(uint64_t limit); // every prime <= min(limit, MAX_PRIME_TABLE_LIMIT)
+
+uint64_t prime_pi(uint64_t x); // number of primes <= x
+uint64_t nth_prime(uint64_t n); // nth_prime(1) = 2
+
+// Streams the primes >= start in increasing order. Only one bit-packed segment of the sieve is kept, so memory stays
+// bounded for any range below MAX_PRIME_TABLE_LIMIT^2.
+class PrimeIterator
+{
+	std::vector<uint8_t> segment; // bit i of byte k: low + 30 * k + WHEEL[i] is prime
+	uint64_t low;                 // first number of the segment, a multiple of 30
+	size_t byte;                  // byte being scanned, its bits below the current prime are cleared
+	uint64_t start;
+
+	void sieve_next_segment();
+
+public:
+	explicit PrimeIterator(uint64_t start = 2);
+
+	uint64_t next();
+};
+
+// Smallest prime in [from, to] that divides n, 0 if there is none. Primes are taken in groups whose product fits
+// into a limb: n is reduced modulo the product in one pass over its limbs, then each prime divides a single word.
+uint64_t find_small_divider(const BigInt& n, uint64_t from, uint64_t to);
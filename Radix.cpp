@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Radix.h"
+#include "BigMath.h"
+
+namespace {
+
+const char DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+struct RadixInfo {
+    int chunk_digits;  // digits per limb
+    limb_t chunk_base; // radix^chunk_digits
+    int bits;          // log2(radix) for a power of two, otherwise 0
+};
+
+RadixInfo get_radix_info(int radix) {
+    RadixInfo info{0, 1, 0};
+    if ((radix & (radix - 1)) == 0)
+        info.bits = count_trailing_zeros(radix);
+    while (info.chunk_base <= UINT64_MAX / radix) {
+        info.chunk_base *= radix;
+        ++info.chunk_digits;
+    }
+    return info;
+}
+
+int digit_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'Z') return c - 'A' + 10;
+    return 36;
+}
+
+// powers[radix][i] = chunk_base^(2^i) and inverses[radix][i] = floor(2^(128 * size) / powers[radix][i]) for its size
+// in limbs, the inverses are computed when formatting first needs them. Shared between threads and only appended to.
+std::mutex powers_mutex;
+std::vector<std::shared_ptr<const BigInt>> powers[37], inverses[37];
+
+std::shared_ptr<const BigInt> get_power(int radix, const RadixInfo &info, size_t i) {
+    std::lock_guard<std::mutex> lock(powers_mutex);
+    auto &table = powers[radix];
+    if (table.empty())
+        table.push_back(std::make_shared<const BigInt>(std::vector<limb_t>{info.chunk_base}, 1));
+    while (table.size() <= i)
+        table.push_back(std::make_shared<const BigInt>(*table.back() * *table.back()));
+    return table[i];
+}
+
+// powers[radix][i] is the square of powers[radix][i - 1], so the square of the previous inverse already carries half of
+// the bits of the new one. A Newton step x += x (R - m x) / R for 1 / m then leaves it a few units below.
+std::shared_ptr<const BigInt> get_inverse(int radix, const RadixInfo &info, size_t i) {
+    std::shared_ptr<const BigInt> previous = i > 0 ? get_inverse(radix, info, i - 1) : nullptr;
+    auto power = get_power(radix, info, i);
+    std::lock_guard<std::mutex> lock(powers_mutex);
+    auto &table = inverses[radix];
+    if (table.size() <= i)
+        table.resize(i + 1);
+    if (table[i])
+        return table[i];
+
+    const BigInt &m = *power;
+    int k = m.get_number_of_limbs();
+    BigInt r_power = BigInt(1) << (2 * LIMB_BITS * k), x;
+    if (!previous)
+        x = r_power / m;
+    else {
+        int previous_k = powers[radix][i - 1]->get_number_of_limbs();
+        x = (*previous * *previous) >> (2 * LIMB_BITS * (2 * previous_k - k));
+        x += (x * (r_power - m * x)) >> (2 * LIMB_BITS * k);
+
+        BigInt r = r_power - m * x;
+        for (int step = 0; r < 0 || r >= m; ++step) {
+            if (step == 8) {
+                x = r_power / m;
+                break;
+            }
+            x += r < 0 ? -1 : 1;
+            r += r < 0 ? m : -m;
+        }
+    }
+
+    table[i] = std::make_shared<const BigInt>(std::move(x));
+    return table[i];
+}
+
+// q = a / m and r = a % m for 0 <= a < m^2 by Barrett's reduction with the cached inverse of m = powers[radix][i],
+// two multiplications instead of a division
+void divide_by_power(const BigInt &a, int radix, const RadixInfo &info, size_t i, BigInt &q, BigInt &r) {
+    const BigInt &m = *get_power(radix, info, i);
+    int k = m.get_number_of_limbs();
+    q = ((a >> (LIMB_BITS * (k - 1))) * *get_inverse(radix, info, i)) >> (LIMB_BITS * (k + 1));
+    r = a - q * m;
+    while (r >= m) {
+        r -= m;
+        q += 1;
+    }
+}
+
+bool parse_power_of_two(std::string_view s, int bits, BigInt &result) {
+    std::vector<limb_t> limbs((s.size() * bits + LIMB_BITS - 1) / LIMB_BITS);
+    size_t position = 0;
+    for (size_t i = s.size(); i-- > 0; position += bits) {
+        limb_t digit = digit_value(s[i]);
+        if (digit >= ((limb_t) 1 << bits))
+            return false;
+
+        limbs[position / LIMB_BITS] |= digit << (position % LIMB_BITS);
+        if (position % LIMB_BITS + bits > LIMB_BITS)
+            limbs[position / LIMB_BITS + 1] |= digit >> (LIMB_BITS - position % LIMB_BITS);
+    }
+
+    result = BigInt(limbs, 1);
+    return true;
+}
+
+// chunk by chunk, the first chunk absorbs the remainder of the length
+bool parse_simple(std::string_view s, int radix, const RadixInfo &info, BigInt &result) {
+    std::vector<limb_t> limbs;
+    limbs.reserve(s.size() / info.chunk_digits + 1);
+    size_t first = s.size() % info.chunk_digits;
+    for (size_t i = 0; i < s.size();) {
+        size_t end = (i == 0 && first != 0) ? first : i + info.chunk_digits;
+        limb_t chunk = 0, multiplier = 1;
+        for (; i < end; ++i) {
+            limb_t digit = digit_value(s[i]);
+            if (digit >= (limb_t) radix)
+                return false;
+            chunk = chunk * radix + digit;
+            multiplier *= radix;
+        }
+
+        limb_t carry = multiply_limb(limbs.data(), limbs.data(), limbs.size(), multiplier);
+        if (carry != 0)
+            limbs.push_back(carry);
+        carry = add_limb(limbs.data(), limbs.data(), limbs.size(), chunk);
+        if (carry != 0)
+            limbs.push_back(carry);
+    }
+
+    result = BigInt(limbs, 1);
+    return true;
+}
+
+// the last chunk_digits * 2^i digits for the largest such count below the length are the low part
+bool parse_range(std::string_view s, int radix, const RadixInfo &info, BigInt &result) {
+    if (s.size() <= DIVIDE_AND_CONQUER_LIMBS * info.chunk_digits)
+        return parse_simple(s, radix, info, result);
+
+    size_t i = 0;
+    while ((size_t) info.chunk_digits << (i + 1) < s.size())
+        ++i;
+    size_t low_digits = (size_t) info.chunk_digits << i;
+
+    BigInt low;
+    if (!parse_range(s.substr(0, s.size() - low_digits), radix, info, result) ||
+        !parse_range(s.substr(s.size() - low_digits), radix, info, low))
+        return false;
+
+    result *= *get_power(radix, info, i);
+    result += low;
+    return true;
+}
+
+void format_power_of_two(const BigInt &a, int bits, std::string &out) {
+    auto limbs = a.get_limbs();
+    size_t count = (bit_length(limbs.data(), limbs.size()) + bits - 1) / bits;
+    for (size_t i = count; i-- > 0;)
+        out.push_back(DIGITS[get_bits(limbs.data(), limbs.size(), i * bits, bits)]);
+}
+
+// appends the digits of a zero-padded to width
+void format_simple(const BigInt &a, int radix, const RadixInfo &info, size_t width, std::string &out) {
+    auto a_limbs = a.get_limbs();
+    std::vector<limb_t> limbs(a_limbs.begin(), a_limbs.end());
+    std::string digits; // least significant first
+    for (size_t n = limbs.size(); n > 0; n = normalized_size(limbs.data(), n)) {
+        limb_t chunk = divide_limb(limbs.data(), limbs.data(), n, info.chunk_base);
+        for (int j = 0; j < info.chunk_digits; ++j, chunk /= radix)
+            digits.push_back(DIGITS[chunk % radix]);
+    }
+
+    while (!digits.empty() && digits.back() == '0')
+        digits.pop_back();
+    if (digits.size() < width)
+        out.append(width - digits.size(), '0');
+    out.append(digits.rbegin(), digits.rend());
+}
+
+// for a < powers[radix][level]: splits at the next lower power into a high and a low half, the low half and any
+// high half below width are padded with zeros
+void format_range(const BigInt &a, int radix, const RadixInfo &info, size_t level, size_t width, std::string &out) {
+    if (a.get_limbs().size() <= DIVIDE_AND_CONQUER_LIMBS) {
+        format_simple(a, radix, info, width, out);
+        return;
+    }
+
+    size_t low_digits = (size_t) info.chunk_digits << (level - 1);
+    if (width <= low_digits && a < *get_power(radix, info, level - 1)) {
+        format_range(a, radix, info, level - 1, width, out);
+        return;
+    }
+
+    BigInt q, r;
+    divide_by_power(a, radix, info, level - 1, q, r);
+    format_range(q, radix, info, level - 1, width > low_digits ? width - low_digits : 0, out);
+    format_range(r, radix, info, level - 1, low_digits, out);
+}
+}
+
+bool parse_magnitude(std::string_view digits, int radix, BigInt &result) {
+    if (digits.empty() || radix < 2 || radix > 36)
+        return false;
+
+    RadixInfo info = get_radix_info(radix);
+    return info.bits != 0 ? parse_power_of_two(digits, info.bits, result) : parse_range(digits, radix, info, result);
+}
+
+void format_magnitude(const BigInt &a, int radix, std::string &out) {
+    if (radix < 2 || radix > 36) throw "RadixOutOfRange";
+
+    if (a == 0) {
+        out.push_back('0');
+        return;
+    }
+
+    RadixInfo info = get_radix_info(radix);
+    if (info.bits != 0)
+        format_power_of_two(a, info.bits, out);
+    else {
+        BigInt magnitude = abs(a);
+        size_t level = 0;
+        while (magnitude.get_limbs().size() > DIVIDE_AND_CONQUER_LIMBS && *get_power(radix, info, level) <= magnitude)
+            ++level;
+        format_range(magnitude, radix, info, level, 0, out);
+    }
+}
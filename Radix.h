@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include "BigInt.h"
+
+// Conversion between magnitudes and digit strings in radix 2 to 36, digits 0-9 then a-z (either case when parsing).
+// Power-of-two radices map digits straight to bits. Other radices use chunks of as many digits as fit into a limb,
+// and beyond DIVIDE_AND_CONQUER_LIMBS limbs split the string or the number at cached powers
+// chunk_base^(2^i), so a conversion costs O(M(n) log n) instead of the quadratic chunk by chunk loop.
+const size_t DIVIDE_AND_CONQUER_LIMBS = 32;
+
+bool parse_magnitude(std::string_view digits, int radix, BigInt& result); // false on no digits or a non-digit
+void format_magnitude(const BigInt& a, int radix, std::string& out); // appends the digits of |a|, "0" for zero
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include "Serialization.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HAVE_MMAP 1
+#endif
+
+static const uint64_t MAGIC = 0x0053544E49474942; // "BIGINTS\0" read as a little-endian word
+
+static uint64_t to_little_endian(uint64_t x) {
+    if constexpr (std::endian::native == std::endian::big)
+        return __builtin_bswap64(x);
+    return x;
+}
+
+static void write_words(std::ostream &out, const uint64_t *words, size_t n) {
+    if constexpr (std::endian::native == std::endian::little)
+        out.write(reinterpret_cast<const char *>(words), n * sizeof(uint64_t));
+    else
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t word = to_little_endian(words[i]);
+            out.write(reinterpret_cast<const char *>(&word), sizeof word);
+        }
+}
+
+// reads n words unless the stream ends first
+static bool read_words(std::istream &in, uint64_t *words, size_t n) {
+    in.read(reinterpret_cast<char *>(words), n * sizeof(uint64_t));
+    if ((size_t) in.gcount() != n * sizeof(uint64_t))
+        return false;
+    for (size_t i = 0; i < n; ++i)
+        words[i] = to_little_endian(words[i]);
+    return true;
+}
+
+void write_record(std::ostream &out, const BigInt &a) {
+    auto limbs = a.get_limbs();
+    uint64_t header = limbs.size() * 2 + (a.get_sign() < 0 ? 1 : 0);
+    write_words(out, &header, 1);
+    write_words(out, limbs.data(), limbs.size());
+}
+
+bool read_record(std::istream &in, BigInt &a) {
+    uint64_t header;
+    if (!read_words(in, &header, 1)) {
+        if (in.gcount() != 0) throw "CorruptBigIntStream";
+        return false;
+    }
+
+    // one buffer per thread, the value gets its own copy. It grows by at most a chunk ahead of the words actually
+    // read, so a corrupt length runs into the end of the stream instead of allocating it
+    const size_t CHUNK_LIMBS = 1 << 16;
+    thread_local std::vector<limb_t> limbs;
+    uint64_t n = header / 2;
+    limbs.clear();
+    while (limbs.size() < n) {
+        size_t read = limbs.size(), chunk = std::min<uint64_t>(n - read, CHUNK_LIMBS);
+        limbs.resize(read + chunk);
+        if (!read_words(in, limbs.data() + read, chunk))
+            throw "CorruptBigIntStream";
+    }
+    if ((!limbs.empty() && limbs.back() == 0) || header == 1)
+        throw "CorruptBigIntStream";
+
+    a = BigInt(std::span<const limb_t>(limbs), header & 1 ? -1 : 1);
+    return true;
+}
+
+BigIntWriter::BigIntWriter(std::ostream &out) : out(out) {
+    uint64_t header[2] = {MAGIC, FORMAT_VERSION};
+    write_words(out, header, 2);
+}
+
+void BigIntWriter::write(const BigInt &a) {
+    write_record(out, a);
+}
+
+BigIntReader::BigIntReader(std::istream &in) : in(in) {
+    uint64_t header[2];
+    if (!read_words(in, header, 2) || header[0] != MAGIC || header[1] != FORMAT_VERSION)
+        throw "UnsupportedBigIntStream";
+}
+
+bool BigIntReader::read(BigInt &a) {
+    return read_record(in, a);
+}
+
+BigInt BigIntView::to_BigInt() const {
+    return BigInt(limbs, sign);
+}
+
+BigIntArray::BigIntArray() : arena{MAGIC, FORMAT_VERSION}, words(arena.data()), word_count(2), mapping(nullptr),
+                             mapping_size(0) {}
+
+BigIntArray::BigIntArray(BigIntArray &&other) noexcept : BigIntArray() {
+    *this = std::move(other);
+}
+
+BigIntArray &BigIntArray::operator=(BigIntArray &&other) noexcept {
+    std::swap(arena, other.arena);
+    std::swap(words, other.words);
+    std::swap(word_count, other.word_count);
+    std::swap(offsets, other.offsets);
+    std::swap(mapping, other.mapping);
+    std::swap(mapping_size, other.mapping_size);
+    return *this;
+}
+
+BigIntArray::~BigIntArray() {
+#ifdef HAVE_MMAP
+    if (mapping)
+        munmap(mapping, mapping_size);
+#endif
+}
+
+// checks the header and every record and collects the record offsets
+void BigIntArray::index() {
+    if (word_count < 2 || words[0] != MAGIC || words[1] != FORMAT_VERSION)
+        throw "UnsupportedBigIntStream";
+
+    offsets.clear();
+    for (size_t offset = 2; offset < word_count;) {
+        uint64_t n = words[offset] / 2;
+        if (n > word_count - offset - 1 || (n != 0 && words[offset + n] == 0) || words[offset] == 1)
+            throw "CorruptBigIntStream";
+        offsets.push_back(offset);
+        offset += n + 1;
+    }
+}
+
+BigIntArray BigIntArray::map_file(const std::string &path) {
+    if constexpr (std::endian::native != std::endian::little)
+        throw "UnsupportedByteOrder";
+
+    BigIntArray array;
+#ifdef HAVE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw "CannotOpenFile";
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size < 16 || status.st_size % sizeof(limb_t) != 0) {
+        close(fd);
+        throw "UnsupportedBigIntStream";
+    }
+
+    void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) throw "CannotOpenFile";
+
+    array.arena.clear();
+    array.mapping = mapping;
+    array.mapping_size = status.st_size;
+    array.words = static_cast<const limb_t *>(mapping);
+    array.word_count = status.st_size / sizeof(limb_t);
+#else
+    // without mmap the file is read into the arena once
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) throw "CannotOpenFile";
+    size_t bytes = in.tellg();
+    if (bytes % sizeof(limb_t) != 0) throw "UnsupportedBigIntStream";
+    array.arena.resize(bytes / sizeof(limb_t));
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(array.arena.data()), bytes);
+    array.words = array.arena.data();
+    array.word_count = array.arena.size();
+#endif
+
+    array.index();
+    return array;
+}
+
+size_t BigIntArray::size() const {
+    return offsets.size();
+}
+
+BigIntView BigIntArray::operator[](size_t i) const {
+    const limb_t *record = words + offsets[i];
+    size_t n = record[0] / 2;
+    return {n == 0 ? 0 : record[0] & 1 ? -1 : 1, {record + 1, n}};
+}
+
+void BigIntArray::push_back(const BigInt &a) {
+    if (mapping) throw "ReadOnlyArray";
+
+    auto limbs = a.get_limbs();
+    offsets.push_back(arena.size());
+    arena.push_back(limbs.size() * 2 + (a.get_sign() < 0 ? 1 : 0));
+    arena.insert(arena.end(), limbs.begin(), limbs.end());
+    words = arena.data();
+    word_count = arena.size();
+}
+
+void BigIntArray::save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw "CannotOpenFile";
+    write_words(out, words, word_count);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BigInt.h"
+
+// Binary format, every field a little-endian 64-bit word:
+//   stream header: the magic "BIGINTS\0", then FORMAT_VERSION
+//   record:        limb count * 2 + (1 if negative), then the limbs, least significant first, the top one nonzero
+// Records stay 8-byte aligned, so a mapped file can be read in place.
+const uint64_t FORMAT_VERSION = 1;
+
+void write_record(std::ostream&, const BigInt&);
+bool read_record(std::istream&, BigInt&); // false at the end of the stream, throws "CorruptBigIntStream" on a bad record
+
+// Sequential writer and reader of a whole stream, for files larger than memory
+class BigIntWriter
+{
+	std::ostream& out;
+
+public:
+	explicit BigIntWriter(std::ostream& out); // writes the header
+
+	void write(const BigInt&);
+};
+
+class BigIntReader
+{
+	std::istream& in;
+
+public:
+	explicit BigIntReader(std::istream& in); // checks the header, throws "UnsupportedBigIntStream"
+
+	bool read(BigInt&); // false after the last value
+};
+
+// a value in a BigIntArray, valid as long as the array
+struct BigIntView
+{
+	int sign;
+	std::span<const limb_t> limbs;
+
+	BigInt to_BigInt() const;
+};
+
+// Many values stored back to back as records in one block of words, which is either owned or a read-only mapping of
+// a file in the stream format. Elements are read in place without allocation, only an index of record offsets is
+// built when a file is mapped.
+class BigIntArray
+{
+	std::vector<limb_t> arena;  // header and records of an owned array
+	const limb_t* words;        // arena or the mapping
+	size_t word_count;
+	std::vector<size_t> offsets; // word offset of every record
+	void* mapping;
+	size_t mapping_size;
+
+	void index();
+
+public:
+	BigIntArray();
+	BigIntArray(BigIntArray&&) noexcept;
+	BigIntArray& operator=(BigIntArray&&) noexcept;
+	BigIntArray(const BigIntArray&) = delete;
+	BigIntArray& operator=(const BigIntArray&) = delete;
+	~BigIntArray();
+
+	static BigIntArray map_file(const std::string& path); // read-only, throws "CannotOpenFile"
+
+	size_t size() const;
+	BigIntView operator[](size_t i) const;
+	void push_back(const BigInt&); // throws "ReadOnlyArray" for a mapped file
+	void save(const std::string& path) const;
+};
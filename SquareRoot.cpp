@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "NumberTheory.h"
+#include "SquareRoot.h"
+
+namespace {
+
+BigInt residue(const BigInt &a, const BigInt &m) {
+    BigInt r = a % m;
+    if (r < 0)
+        r += m;
+    return r;
+}
+
+Factorization factorization_of(const BigInt &m) {
+    if (m < 1) throw "ModulusIsNotPositive";
+    return factorize(m);
+}
+
+std::vector<BigInt> moduli_of(const Factorization &factorization) {
+    std::vector<BigInt> moduli;
+    for (auto &[p, e] : factorization)
+        moduli.push_back(big_pow(p, e));
+    return moduli;
+}
+
+}
+
+SquareRootContext::SquareRootContext(const BigInt &m) : SquareRootContext(m, factorization_of(m)) {}
+
+SquareRootContext::SquareRootContext(const BigInt &m, const Factorization &factorization)
+        : modulus(m), basis(moduli_of(factorization)) {
+    // the basis has the prime powers in the order of the factorization
+    auto &powers = basis.get_moduli();
+    for (size_t i = 0; i < factorization.size(); ++i) {
+        auto &[p, e] = factorization[i];
+        PrimePower f{p, powers[i], e, ModContext(p), p - 1, 0, 0, false};
+        if (p == 2) {
+            factors.push_back(std::move(f));
+            continue;
+        }
+
+        while (f.odd % 2 == 0)
+            f.odd >>= 1, f.s++;
+
+        // the first non-residue among 2, 3, 4, ... is small, below 2 ln(p)^2 under GRH
+        BigInt z = 2;
+        while (Jacobi_symbol(z, p) != -1)
+            z += 1;
+        f.root_of_unity = f.context.pow(ModInt(f.context, z), f.odd).to_BigInt();
+
+        // Tonelli-Shanks takes up to s (s - 1) / 4 extra multiplications, Cipolla doubles the cost of the power
+        size_t bits = bit_length(p.get_limbs().data(), p.get_number_of_limbs());
+        f.Cipolla = f.s * (f.s - 1) > 8 * (int) bits + 20;
+        factors.push_back(std::move(f));
+    }
+}
+
+const BigInt &SquareRootContext::get_modulus() const {
+    return modulus;
+}
+
+// x with x^2 = b (mod p) for b not divisible by the odd prime p, -1 if b is a non-residue
+BigInt SquareRootContext::prime_root(const PrimePower &f, const BigInt &b) const {
+    auto &context = f.context;
+    const BigInt &p = f.prime;
+    ModInt a(context, b), one = context.get_one();
+    ModInt x = one;
+
+    if (f.s == 1)
+        x = context.pow(a, (p + 1) / 4);
+    else if (f.s == 2) {
+        // Atkin: v = (2a)^((p - 5) / 8), i = 2 a v^2 is a square root of -1 and x = a v (i - 1)
+        ModInt a2 = a + a, v = context.pow(a2, (p - 5) / 8);
+        ModInt i = a2 * v * v;
+        x = a * v * (i - one);
+    } else if (!f.Cipolla) {
+        // x = a^((odd + 1) / 2) is off by t = a^odd in the 2-power subgroup, which c of order 2^m corrects bit by bit
+        x = context.pow(a, (f.odd + 1) / 2);
+        ModInt t = context.pow(a, f.odd), c(context, f.root_of_unity);
+        int m = f.s;
+        while (t != one) {
+            int i = 1;
+            for (ModInt t2 = t * t; t2 != one; t2.square())
+                if (++i == m)
+                    return -1;
+            ModInt d = c;
+            for (int j = 0; j < m - i - 1; ++j)
+                d.square();
+            m = i;
+            c = d * d;
+            t *= c;
+            x *= d;
+        }
+    } else {
+        if (Jacobi_symbol(b, p) != 1)
+            return -1;
+
+        // (t + w)^((p + 1) / 2) in F_p(w) with w^2 = t^2 - a a non-residue
+        ModInt t = one, w2 = one - a;
+        while (Jacobi_symbol(w2.to_BigInt(), p) != -1) {
+            t += one;
+            w2 = t * t - a;
+        }
+
+        ModInt r0 = one, r1(context, 0), k0 = t, k1 = one;
+        BigInt d = (p + 1) / 2;
+        while (d != 0) {
+            if (d % 2 == 1) {
+                ModInt next = k0 * r1 + k1 * r0;
+                r0 = k0 * r0 + w2 * k1 * r1;
+                r1 = std::move(next);
+            }
+            d >>= 1;
+            ModInt cross = k0 * k1;
+            k0 = k0 * k0 + w2 * k1 * k1;
+            k1 = cross + cross;
+        }
+        x = r0;
+    }
+
+    return x * x == a ? x.to_BigInt() : BigInt(-1);
+}
+
+// every root modulo p^exponent of b coprime to p
+std::vector<BigInt> SquareRootContext::unit_roots(const PrimePower &f, const BigInt &b, int exponent) const {
+    const BigInt &p = f.prime;
+    BigInt q = big_pow(p, exponent);
+    if (p == 2) {
+        if (exponent == 1)
+            return {1};
+        if (exponent == 2)
+            return b % 4 == 1 ? std::vector<BigInt>{1, 3} : std::vector<BigInt>{};
+        if (b % 8 != 1)
+            return {};
+
+        // x^2 = b (mod 2^i) for odd x extends to 2^(i + 1) by x or x + 2^(i - 1)
+        BigInt x = 1;
+        for (int i = 3; i < exponent; ++i)
+            if ((x * x - b) % (BigInt(1) << (i + 1)) != 0)
+                x += BigInt(1) << (i - 1);
+
+        BigInt half = q >> 1;
+        std::vector<BigInt> result{x, q - x, (x + half) % q, (q - x + half) % q};
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    BigInt x = prime_root(f, b % p);
+    if (x < 0)
+        return {};
+
+    // Newton's iteration x - (x^2 - b) / (2 x) doubles the exponent of p that the root is known modulo
+    for (BigInt known = p; known < q;) {
+        known = std::min(known * known, q);
+        x = residue(x - (x * x - b) * inverse_modulo(2 * x, known), known);
+    }
+
+    return {std::min(x, q - x), std::max(x, q - x)};
+}
+
+// roots modulo p^k: b = p^v b' with even v < k gives x = p^(v / 2) y for y = sqrt(b') modulo p^(k - v) and any
+// multiple of p^(k - v) added to y
+std::vector<BigInt> SquareRootContext::prime_power_roots(const PrimePower &f, const BigInt &b, bool all) const {
+    const BigInt &p = f.prime;
+    int k = f.exponent;
+    BigInt r = residue(b, f.power);
+
+    std::vector<BigInt> result;
+    if (r == 0) {
+        // x = 0 (mod p^ceil(k / 2))
+        BigInt step = big_pow(p, (k + 1) / 2), count = all ? big_pow(p, k / 2) : BigInt(1);
+        for (BigInt j = 0; j < count; j += 1)
+            result.push_back(j * step);
+        return result;
+    }
+
+    int v = 0;
+    for (; r % p == 0; r /= p)
+        ++v;
+    if (v % 2 == 1)
+        return {};
+
+    auto units = unit_roots(f, r, k - v);
+    if (units.empty())
+        return {};
+
+    BigInt scale = big_pow(p, v / 2), lifted = big_pow(p, k - v), count = all ? scale : BigInt(1);
+    for (auto &y : units) {
+        for (BigInt j = 0; j < count; j += 1)
+            result.push_back(scale * (y + j * lifted));
+        if (!all)
+            break;
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+BigInt SquareRootContext::root(const BigInt &b) const {
+    std::vector<BigInt> residues;
+    for (auto &f : factors) {
+        auto roots = prime_power_roots(f, b, false);
+        if (roots.empty())
+            return -1;
+        residues.push_back(std::move(roots[0]));
+    }
+
+    return basis.solve(residues);
+}
+
+std::vector<BigInt> SquareRootContext::roots(const BigInt &b) const {
+    std::vector<std::vector<BigInt>> choices;
+    for (auto &f : factors) {
+        choices.push_back(prime_power_roots(f, b, true));
+        if (choices.back().empty())
+            return {};
+    }
+
+    // every combination of a root modulo each prime power, counted like a mixed radix number
+    std::vector<BigInt> result, residues(factors.size());
+    std::vector<size_t> index(factors.size(), 0);
+    while (true) {
+        for (size_t i = 0; i < factors.size(); ++i)
+            residues[i] = choices[i][index[i]];
+        result.push_back(basis.solve(residues));
+
+        size_t i = 0;
+        while (i < factors.size() && ++index[i] == choices[i].size())
+            index[i++] = 0;
+        if (i == factors.size())
+            break;
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<BigInt> discrete_sqrt_batch(const std::vector<BigInt> &b, const BigInt &m) {
+    SquareRootContext context(m);
+    std::vector<BigInt> result(b.size());
+
+    // a root takes microseconds, threads pay off only for long batches
+    unsigned threads = b.size() >= 1024 ? (unsigned) std::min<size_t>(get_factorization_threads(), b.size() / 256) : 1;
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < b.size();)
+            result[i] = context.root(b[i]);
+    };
+
+    if (threads <= 1)
+        worker();
+    else {
+        std::vector<std::thread> pool;
+        for (unsigned i = 0; i < threads; ++i)
+            pool.emplace_back(worker);
+        for (auto &thread : pool)
+            thread.join();
+    }
+
+    return result;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "CRT.h"
+#include "Factorization.h"
+#include "ModContext.h"
+
+// Square roots modulo a fixed positive modulus m. The factorization of m is found once, with a quadratic non-residue
+// and the Tonelli-Shanks constants of every odd prime and a CRT basis of the prime powers. A root modulo p comes from
+// one exponentiation for p = 3 (mod 4) and p = 5 (mod 8), otherwise from Tonelli-Shanks, or from Cipolla when a long
+// power of 2 in p - 1 would make Tonelli-Shanks quadratic. Roots are Hensel-lifted to the prime powers and combined.
+// A context is immutable after construction, so it can be shared between threads.
+class SquareRootContext
+{
+	struct PrimePower
+	{
+		BigInt prime, power;
+		int exponent;
+		ModContext context; // modulo the prime
+		BigInt odd;         // p - 1 = odd * 2^s
+		int s;
+		BigInt root_of_unity; // z^odd for a non-residue z, of order 2^s
+		bool Cipolla;
+	};
+
+	BigInt modulus;
+	std::vector<PrimePower> factors;
+	CRTBasis basis;
+
+	BigInt prime_root(const PrimePower& f, const BigInt& b) const;
+	std::vector<BigInt> unit_roots(const PrimePower& f, const BigInt& b, int exponent) const;
+	std::vector<BigInt> prime_power_roots(const PrimePower& f, const BigInt& b, bool all) const;
+
+	SquareRootContext(const BigInt& m, const Factorization& factorization);
+
+public:
+	explicit SquareRootContext(const BigInt& m); // throws "ModulusIsNotPositive"
+
+	const BigInt& get_modulus() const;
+
+	BigInt root(const BigInt& b) const; // some x with x^2 = b (mod m), -1 if b is not a square modulo m
+
+	// Every x in [0, m) with x^2 = b (mod m), increasing. A prime power p^k sharing p^v with b multiplies their
+	// number by p^(v / 2), so for b far from coprime to m there can be very many.
+	std::vector<BigInt> roots(const BigInt& b) const;
+};
+
+// root of every b[i] modulo m from one SquareRootContext, -1 where there is none, over get_factorization_threads()
+// threads for long batches
+std::vector<BigInt> discrete_sqrt_batch(const std::vector<BigInt>& b, const BigInt& m);
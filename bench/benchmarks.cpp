@@ -0,0 +1,317 @@
+// Benchmarks of the BigMath and NumberTheory entry points: arithmetic over operand sizes from 64 bits to 1M bits,
+// modular exponentiation, CRT and discrete logarithms, loops over word-sized values, and factorization of fixed-seed
+// corpora of semiprimes, smooth numbers and prime powers. Names are operation/size in bits, or operation/corpus.
+//
+//   cmake -S .. -B build && cmake --build build --target benchmarks
+//   build/bench/benchmarks --benchmark_out=before.json
+//   python3 compare.py before.json after.json
+//
+// Factorizations run on one thread with the factorization cache disabled, so that repeated calls do the same work
+// and runs on different machines compare.
+
+#include <string>
+#include <vector>
+#include "CRT.h"
+#include "Factorization.h"
+#include "NumberTheory.h"
+#include "harness.h"
+
+using bench::keep;
+using bench::random_bits;
+using bench::Operation;
+
+static const size_t MAX_BITS = (size_t) 1 << 20;
+
+// name/bits for bits = 64, 256, 1024, ... up to max_bits
+static void sweep(const std::string &name, size_t max_bits, std::function<Operation(size_t)> setup) {
+    for (size_t bits = 64; bits <= max_bits; bits *= 4)
+        bench::add(name + "/" + std::to_string(bits), [=]() { return setup(bits); });
+}
+
+static BigInt random_odd(size_t bits) {
+    BigInt a = random_bits(bits);
+    return a % 2 == 0 ? a + 1 : a;
+}
+
+static BigInt random_prime(size_t bits) {
+    BigInt p = random_odd(bits);
+    while (!is_prime(p))
+        p += 2;
+    return p;
+}
+
+// p = 2q + 1 with q prime, the hardest case for Pohlig-Hellman
+static BigInt random_safe_prime(size_t bits) {
+    while (true) {
+        BigInt q = random_prime(bits - 1), p = 2 * q + 1;
+        if (is_prime(p))
+            return p;
+    }
+}
+
+// p with p - 1 a product of primes below 2^16
+static BigInt random_smooth_prime(size_t bits) {
+    while (true) {
+        BigInt p = 2;
+        while (bit_length(p.get_limbs().data(), p.get_number_of_limbs()) < bits)
+            p *= random_prime(16);
+        if (is_prime(p + 1))
+            return p + 1;
+    }
+}
+
+static void arithmetic() {
+    sweep("add", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), b = random_bits(bits);
+        return [=]() { keep(a + b); };
+    });
+    sweep("multiply", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), b = random_bits(bits);
+        return [=]() { keep(a * b); };
+    });
+    sweep("square", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits);
+        return [=]() { keep(a * a); };
+    });
+    // 2n bits by n bits
+    sweep("divide", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(2 * bits), b = random_bits(bits);
+        return [=]() { keep(a / b); };
+    });
+    sweep("modulo", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(2 * bits), b = random_bits(bits);
+        return [=]() { keep(a % b); };
+    });
+    sweep("shift", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits);
+        return [=]() { keep(a << 37); };
+    });
+    sweep("sqrt", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits);
+        return [=]() { keep(sqrt(a)); };
+    });
+    sweep("root3", MAX_BITS / 4, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits);
+        return [=]() { keep(root(a, 3)); };
+    });
+    sweep("to_string", MAX_BITS / 4, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits);
+        return [=]() { bench::sink = bench::sink + a.to_string().size(); };
+    });
+    sweep("parse", MAX_BITS / 4, [](size_t bits) -> Operation {
+        std::string s = random_bits(bits).to_string();
+        return [=]() { keep(BigInt(s)); };
+    });
+}
+
+static void modular() {
+    sweep("multiply_modulo", MAX_BITS, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), b = random_bits(bits), m = random_odd(bits);
+        return [=]() { keep(multiply_modulo(a, b, m)); };
+    });
+    sweep("pow_modulo", 8192, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), e = random_bits(bits), m = random_odd(bits);
+        return [=]() { keep(big_pow_modulo(a, e, m)); };
+    });
+    sweep("pow_modulo_even", 4096, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), e = random_bits(bits), m = random_odd(bits) + 1;
+        return [=]() { keep(big_pow_modulo(a, e, m)); };
+    });
+    sweep("pow_modulo_constant_time", 4096, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), e = random_bits(bits), m = random_odd(bits);
+        return [=]() { keep(big_pow_modulo_constant_time(a, e, m)); };
+    });
+    sweep("multi_pow_modulo", 4096, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), x = random_bits(bits), b = random_bits(bits), y = random_bits(bits);
+        BigInt m = random_odd(bits);
+        return [=]() { keep(big_multi_pow_modulo(a, x, b, y, m)); };
+    });
+    sweep("gcd", MAX_BITS / 16, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), b = random_bits(bits);
+        return [=]() { keep(gcd(a, b)); };
+    });
+    sweep("extended_gcd", MAX_BITS / 16, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), b = random_bits(bits);
+        return [=]() {
+            BigInt x, y;
+            keep(extended_gcd(a, b, x, y));
+        };
+    });
+    sweep("inverse_modulo", MAX_BITS / 16, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits - 1), m = random_odd(bits);
+        while (gcd(a, m) != 1)
+            a += 1;
+        return [=]() { keep(inverse_modulo(a, m)); };
+    });
+    sweep("batch_inverse_modulo_1000", 4096, [](size_t bits) -> Operation {
+        BigInt m = random_odd(bits);
+        std::vector<BigInt> a;
+        for (int i = 0; i < 1000; ++i) {
+            a.push_back(random_bits(bits - 1));
+            while (gcd(a.back(), m) != 1)
+                a.back() += 1;
+        }
+        return [=]() { keep(batch_inverse_modulo(a, m)[0]); };
+    });
+    sweep("Jacobi_symbol", MAX_BITS / 16, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits), n = random_odd(bits);
+        return [=]() { bench::sink = bench::sink + Jacobi_symbol(a, n); };
+    });
+    sweep("discrete_sqrt", 1024, [](size_t bits) -> Operation {
+        BigInt p = random_prime(bits), x = random_bits(bits - 1), b = x * x % p;
+        return [=]() { keep(discrete_sqrt(b, p)); };
+    });
+
+    // k congruences modulo 64-bit primes
+    for (size_t k : {16, 256, 4096})
+        bench::add("CRTH/" + std::to_string(k), [k]() -> Operation {
+            std::vector<BigInt> a, m;
+            for (size_t i = 0; i < k; ++i) {
+                m.push_back(random_prime(64));
+                a.push_back(random_bits(63));
+            }
+            return [=]() { keep(CRTH(a, m)); };
+        });
+
+    for (size_t bits : {32, 40})
+        bench::add("discrete_logarithm/safe_prime/" + std::to_string(bits), [bits]() -> Operation {
+            BigInt p = random_safe_prime(bits), g = 3, h = big_pow_modulo(g, random_bits(bits - 2), p);
+            return [=]() { keep(discrete_logarithm(g, h, p)); };
+        });
+    for (size_t bits : {128, 512})
+        bench::add("discrete_logarithm/smooth_prime/" + std::to_string(bits), [bits]() -> Operation {
+            BigInt p = random_smooth_prime(bits), g = 3, h = big_pow_modulo(g, random_bits(bits - 2), p);
+            return [=]() { keep(discrete_logarithm(g, h, p)); };
+        });
+}
+
+static void primality() {
+    sweep("is_prime", 4096, [](size_t bits) -> Operation {
+        BigInt p = random_prime(bits);
+        return [=]() { bench::sink = bench::sink + is_prime(p); };
+    });
+    sweep("Miller_Rabin_test", 4096, [](size_t bits) -> Operation {
+        BigInt p = random_prime(bits);
+        return [=]() { bench::sink = bench::sink + Miller_Rabin_test(p, 8); };
+    });
+    sweep("is_perfect_power", MAX_BITS / 64, [](size_t bits) -> Operation {
+        BigInt a = random_bits(bits);
+        return [=]() { bench::sink = bench::sink + is_perfect_power(a); };
+    });
+}
+
+// 1000 word-sized values per call, the inline representation and the word paths
+static std::vector<BigInt> random_words(size_t bits) {
+    std::vector<BigInt> words;
+    for (int i = 0; i < 1000; ++i)
+        words.push_back(random_bits(bits));
+    return words;
+}
+
+static void small_values() {
+    bench::add("small/sum/1000", []() -> Operation {
+        std::vector<BigInt> a = random_words(62);
+        return [=]() {
+            BigInt sum = 0;
+            for (auto &x : a)
+                sum += x;
+            keep(sum);
+        };
+    });
+    bench::add("small/multiply_modulo/1000", []() -> Operation {
+        std::vector<BigInt> a = random_words(32), b = random_words(32);
+        BigInt m = random_odd(40);
+        return [=]() {
+            for (size_t i = 0; i < a.size(); ++i)
+                keep(a[i] * b[i] % m);
+        };
+    });
+    bench::add("small/gcd/1000", []() -> Operation {
+        std::vector<BigInt> a = random_words(63), b = random_words(63);
+        return [=]() {
+            for (size_t i = 0; i < a.size(); ++i)
+                keep(gcd(a[i], b[i]));
+        };
+    });
+    // every 16th step takes a 1024-bit operand, the others stay within words
+    bench::add("small/mixed_with_1024/1000", []() -> Operation {
+        std::vector<BigInt> a = random_words(62), b = random_words(30);
+        BigInt large = random_bits(1024), m = random_odd(62);
+        return [=]() {
+            BigInt x = 1;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (i % 16 == 0)
+                    x = (large * a[i] + x) % m;
+                else
+                    x = (x * b[i] + a[i]) % m;
+            }
+            keep(x);
+        };
+    });
+}
+
+// every number of a corpus factored per call
+static void corpus(const std::string &name, std::function<BigInt()> number) {
+    bench::add("factorization_PollardRho/" + name, [=]() -> Operation {
+        std::vector<BigInt> numbers;
+        for (int i = 0; i < 8; ++i)
+            numbers.push_back(number());
+        return [=]() {
+            for (auto &n : numbers)
+                bench::sink = bench::sink + factorization_PollardRho(n).size();
+        };
+    });
+}
+
+static void factorizations() {
+    for (size_t bits : {40, 56, 72})
+        corpus("semiprime/" + std::to_string(bits), [bits]() {
+            return random_prime(bits / 2) * random_prime(bits - bits / 2);
+        });
+    // products of 12 primes below 2^20 and of 6 below 2^32
+    corpus("smooth/20", []() {
+        BigInt n = 1;
+        for (int i = 0; i < 12; ++i)
+            n *= random_prime(20);
+        return n;
+    });
+    corpus("smooth/32", []() {
+        BigInt n = 1;
+        for (int i = 0; i < 6; ++i)
+            n *= random_prime(32);
+        return n;
+    });
+    corpus("prime_power/64^4", []() {
+        return big_pow(random_prime(64), 4);
+    });
+    corpus("prime_power/32^2*32", []() {
+        BigInt p = random_prime(32);
+        return p * p * random_prime(32);
+    });
+
+    bench::add("Euler_function/smooth/20", []() -> Operation {
+        BigInt n = 1;
+        for (int i = 0; i < 12; ++i)
+            n *= random_prime(20);
+        return [=]() { keep(Euler_function(n)); };
+    });
+    bench::add("Mobius_function/smooth/20", []() -> Operation {
+        BigInt n = 1;
+        for (int i = 0; i < 12; ++i)
+            n *= random_prime(20);
+        return [=]() { keep(Mobius_function(n)); };
+    });
+}
+
+int main(int argc, char **argv) {
+    set_factorization_threads(1);
+    set_factorization_cache_capacity(0);
+
+    arithmetic();
+    modular();
+    primality();
+    small_values();
+    factorizations();
+
+    return bench::run(argc, argv);
+}
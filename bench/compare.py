@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Compares two JSON runs of the benchmarks and flags the ones that got slower.
+#
+#   python3 compare.py before.json after.json [--threshold 0.05] [--metric real_time]
+#
+# A benchmark regressed when its time grew by more than the threshold, 5% by default. Benchmarks present in only one
+# of the runs are listed apart. The exit status is 1 if anything regressed, so the script can gate a build.
+
+import argparse
+import json
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        run = json.load(f)
+    scale = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+    times = {}
+    for b in run["benchmarks"]:
+        if b.get("run_type", "iteration") != "iteration":
+            continue
+        times[b["name"]] = b[metric] * scale[b.get("time_unit", "ns")]
+    return times
+
+
+def format_time(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return "%.3g %s" % (ns / scale, unit)
+    return "%.3g ns" % ns
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("contender")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown that counts as a regression")
+    parser.add_argument("--metric", default="real_time", choices=("real_time", "cpu_time"))
+    args = parser.parse_args()
+
+    old, new = load(args.baseline, args.metric), load(args.contender, args.metric)
+    common = [name for name in new if name in old]
+    width = max([len(name) for name in common] + [9])
+
+    regressions = 0
+    print("%-*s %12s %12s %9s" % (width, "benchmark", "baseline", "contender", "change"))
+    for name in common:
+        change = new[name] / old[name] - 1 if old[name] > 0 else 0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions += 1
+        elif change < -args.threshold:
+            flag = "  improvement"
+        print("%-*s %12s %12s %+8.1f%%%s" % (width, name, format_time(old[name]), format_time(new[name]),
+                                            100 * change, flag))
+
+    for name in old:
+        if name not in new:
+            print("only in baseline: %s" % name)
+    for name in new:
+        if name not in old:
+            print("only in contender: %s" % name)
+
+    print("\n%d of %d benchmarks regressed by more than %.0f%%" % (regressions, len(common), 100 * args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,108 @@
+// The arithmetic of the benchmarks next to the same operations of GMP on the same operands, as bigint/... and
+// gmp/... pairs in the JSON format of the benchmarks. Built only when GMP is installed.
+//
+//   build/bench/gmp_comparison --benchmark_filter=multiply
+
+#include <gmp.h>
+#include <memory>
+#include <string>
+#include "NumberTheory.h"
+#include "harness.h"
+
+using bench::keep;
+using bench::random_bits;
+using bench::Operation;
+
+// an mpz_t that clears itself, shared by the copies of an operation
+typedef std::shared_ptr<__mpz_struct> Mpz;
+
+static Mpz make_mpz() {
+    Mpz z(new __mpz_struct, [](__mpz_struct *p) {
+        mpz_clear(p);
+        delete p;
+    });
+    mpz_init(z.get());
+    return z;
+}
+
+static Mpz to_mpz(const BigInt &a) {
+    Mpz z = make_mpz();
+    mpz_import(z.get(), a.get_number_of_limbs(), -1, sizeof(limb_t), 0, 0, a.get_limbs().data());
+    if (a < 0)
+        mpz_neg(z.get(), z.get());
+    return z;
+}
+
+static void keep(const Mpz &z) {
+    bench::sink = bench::sink + mpz_size(z.get());
+}
+
+// both benchmarks of an operation get the operands made by operands(bits)
+template<class Operands, class Ours, class Theirs>
+static void pair(const std::string &name, size_t max_bits, Operands operands, Ours ours, Theirs theirs) {
+    for (size_t bits = 64; bits <= max_bits; bits *= 4) {
+        std::string suffix = name + "/" + std::to_string(bits);
+        // both sides seed from the same name
+        bench::add("bigint/" + suffix, [=]() -> Operation {
+            bench::rng().seed(bench::seed_of(suffix));
+            return ours(operands(bits));
+        });
+        bench::add("gmp/" + suffix, [=]() -> Operation {
+            bench::rng().seed(bench::seed_of(suffix));
+            return theirs(operands(bits));
+        });
+    }
+}
+
+struct Operands {
+    BigInt a, b, m;
+};
+
+int main(int argc, char **argv) {
+    const size_t MAX_BITS = (size_t) 1 << 20;
+    auto random_odd = [](size_t bits) {
+        BigInt a = random_bits(bits);
+        return a % 2 == 0 ? a + 1 : a;
+    };
+    auto same_size = [=](size_t bits) { return Operands{random_bits(bits), random_bits(bits), random_odd(bits)}; };
+    auto double_size = [=](size_t bits) { return Operands{random_bits(2 * bits), random_bits(bits), 1}; };
+
+    pair("multiply", MAX_BITS, same_size, [](Operands o) -> Operation { return [=]() { keep(o.a * o.b); }; },
+         [](Operands o) -> Operation {
+             Mpz a = to_mpz(o.a), b = to_mpz(o.b), r = make_mpz();
+             return [=]() { mpz_mul(r.get(), a.get(), b.get()); keep(r); };
+         });
+    pair("modulo", MAX_BITS, double_size, [](Operands o) -> Operation { return [=]() { keep(o.a % o.b); }; },
+         [](Operands o) -> Operation {
+             Mpz a = to_mpz(o.a), b = to_mpz(o.b), r = make_mpz();
+             return [=]() { mpz_tdiv_r(r.get(), a.get(), b.get()); keep(r); };
+         });
+    pair("sqrt", MAX_BITS, same_size, [](Operands o) -> Operation { return [=]() { keep(sqrt(o.a)); }; },
+         [](Operands o) -> Operation {
+             Mpz a = to_mpz(o.a), r = make_mpz();
+             return [=]() { mpz_sqrt(r.get(), a.get()); keep(r); };
+         });
+    pair("gcd", MAX_BITS / 16, same_size, [](Operands o) -> Operation { return [=]() { keep(gcd(o.a, o.b)); }; },
+         [](Operands o) -> Operation {
+             Mpz a = to_mpz(o.a), b = to_mpz(o.b), r = make_mpz();
+             return [=]() { mpz_gcd(r.get(), a.get(), b.get()); keep(r); };
+         });
+    pair("pow_modulo", 8192, same_size,
+         [](Operands o) -> Operation { return [=]() { keep(big_pow_modulo(o.a, o.b, o.m)); }; },
+         [](Operands o) -> Operation {
+             Mpz a = to_mpz(o.a), b = to_mpz(o.b), m = to_mpz(o.m), r = make_mpz();
+             return [=]() { mpz_powm(r.get(), a.get(), b.get(), m.get()); keep(r); };
+         });
+    pair("to_string", MAX_BITS / 4, same_size,
+         [](Operands o) -> Operation { return [=]() { bench::sink = bench::sink + o.a.to_string().size(); }; },
+         [](Operands o) -> Operation {
+             Mpz a = to_mpz(o.a);
+             return [=]() {
+                 std::unique_ptr<char[]> s(new char[mpz_sizeinbase(a.get(), 10) + 2]);
+                 mpz_get_str(s.get(), 10, a.get());
+                 bench::sink = bench::sink + s[0];
+             };
+         });
+
+    return bench::run(argc, argv);
+}
@@ -0,0 +1,198 @@
+// A small benchmark runner with the command line and JSON output of Google Benchmark, so that runs can be diffed
+// with compare.py or with Google's own tools:
+//
+//   --benchmark_filter=REGEX    only the benchmarks whose name matches
+//   --benchmark_min_time=S      seconds to spend in each benchmark, 0.5 by default
+//   --benchmark_out=FILE        JSON results, written to stdout if FILE is -
+//   --benchmark_list_tests      names of the benchmarks, nothing is run
+//
+// A benchmark is registered with a setup function that returns the operation to time, so operands are only built
+// for the benchmarks that are selected. Times are per call of the operation: iterations grow until min_time has
+// passed after one warm-up call.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BigInt.h"
+
+namespace bench {
+
+typedef std::function<void()> Operation;
+
+struct Benchmark {
+    std::string name;
+    std::function<Operation()> setup;
+};
+
+struct Result {
+    std::string name;
+    size_t iterations;
+    double real_time, cpu_time; // ns per iteration, cpu time of every thread of the process
+};
+
+inline std::vector<Benchmark> &registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+inline void add(std::string name, std::function<Operation()> setup) {
+    registry().push_back({std::move(name), std::move(setup)});
+}
+
+// keeps the compiler from dropping a computation whose result is unused
+inline volatile size_t sink;
+
+inline void keep(const BigInt &a) {
+    sink = sink + a.get_number_of_limbs();
+}
+
+// reseeded from the name of each benchmark before its setup, so operands do not depend on the filter
+inline std::mt19937_64 &rng() {
+    static std::mt19937_64 generator;
+    return generator;
+}
+
+inline uint64_t seed_of(const std::string &name) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : name)
+        h = (h ^ c) * 1099511628211ull;
+    return h;
+}
+
+// uniformly random number of exactly the given length
+inline BigInt random_bits(size_t bits) {
+    std::vector<limb_t> limbs((bits + 63) / 64);
+    for (auto &limb : limbs)
+        limb = rng()();
+    if (bits % 64)
+        limbs.back() &= ((limb_t) 1 << (bits % 64)) - 1;
+    limbs.back() |= (limb_t) 1 << ((bits - 1) % 64);
+    return BigInt(std::move(limbs), 1);
+}
+
+inline Result measure(const std::string &name, const Operation &operation, double min_time) {
+    operation();
+
+    size_t iterations = 1;
+    while (true) {
+        std::clock_t cpu_start = std::clock();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            operation();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cpu = (double) (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+        if (elapsed >= min_time || iterations >= ((size_t) 1 << 40))
+            return {name, iterations, elapsed * 1e9 / iterations, cpu * 1e9 / iterations};
+        // aim a little past min_time from the rate seen so far, at most 10 times more calls
+        double factor = elapsed > 0 ? std::min(10.0, 1.4 * min_time / elapsed) : 10.0;
+        iterations = std::max(iterations + 1, (size_t) (iterations * factor));
+    }
+}
+
+inline std::string escape(const std::string &s) {
+    std::string result;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+inline void write_json(std::ostream &out, const char *executable, const std::vector<Result> &results) {
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"executable\": \"" << escape(executable) << "\",\n"
+        << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"library_build_type\": \"release\"\n"
+#else
+        << "    \"library_build_type\": \"debug\"\n"
+#endif
+        << "  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto &r = results[i];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "%s\n    {\"name\": \"%s\", \"run_name\": \"%s\", \"run_type\": \"iteration\", "
+                      "\"iterations\": %zu, \"real_time\": %.6g, \"cpu_time\": %.6g, \"time_unit\": \"ns\"}",
+                      i ? "," : "", escape(r.name).c_str(), escape(r.name).c_str(), r.iterations, r.real_time,
+                      r.cpu_time);
+        out << line;
+    }
+    out << "\n  ]\n}\n";
+}
+
+inline int run(int argc, char **argv) {
+    std::regex filter(".*");
+    double min_time = 0.5;
+    std::string output;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char *flag) {
+            std::string prefix = std::string(flag) + "=";
+            return arg.rfind(prefix, 0) == 0 ? arg.substr(prefix.size()) : std::string();
+        };
+        if (!value("--benchmark_filter").empty())
+            filter = std::regex(value("--benchmark_filter"));
+        else if (!value("--benchmark_min_time").empty())
+            min_time = std::stod(value("--benchmark_min_time"));
+        else if (!value("--benchmark_out").empty())
+            output = value("--benchmark_out");
+        else if (arg == "--benchmark_list_tests")
+            list = true;
+        else {
+            std::fprintf(stderr, "unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    for (auto &benchmark : registry()) {
+        if (!std::regex_search(benchmark.name, filter))
+            continue;
+        if (list) {
+            std::printf("%s\n", benchmark.name.c_str());
+            continue;
+        }
+
+        rng().seed(seed_of(benchmark.name));
+        Result r = measure(benchmark.name, benchmark.setup(), min_time);
+        std::fprintf(stderr, "%-40s %14.0f ns %14.0f ns %12zu\n", r.name.c_str(), r.real_time, r.cpu_time,
+                     r.iterations);
+        results.push_back(std::move(r));
+    }
+
+    if (output == "-")
+        write_json(std::cout, argv[0], results);
+    else if (!output.empty()) {
+        std::ofstream out(output);
+        write_json(out, argv[0], results);
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", output.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+}
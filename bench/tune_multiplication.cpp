@@ -0,0 +1,86 @@
+// Measures the crossover points between the multiplication algorithms on this machine and prints
+// thresholds for set_multiplication_thresholds().
+//
+//   g++ -O2 -std=c++20 -I.. tune_multiplication.cpp ../*.cpp -o tune_multiplication
+// or the tune_multiplication target of the CMake build.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "Multiplication.h"
+
+typedef void (*multiply_function)(limb_t*, const limb_t*, size_t, const limb_t*, size_t);
+
+static std::mt19937_64 rng(123);
+
+static void schoolbook_square(limb_t *r, const limb_t *a, size_t n, const limb_t *, size_t) {
+    square_schoolbook(r, a, n);
+}
+
+static void karatsuba_square(limb_t *r, const limb_t *a, size_t n, const limb_t *, size_t) {
+    square_karatsuba(r, a, n);
+}
+
+// seconds per call, repeated until at least 20ms were spent
+static double time_per_call(multiply_function f, size_t n) {
+    std::vector<limb_t> a(n), b(n), r(2 * n);
+    for (size_t i = 0; i < n; ++i)
+        a[i] = rng(), b[i] = rng();
+
+    size_t calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        f(r.data(), a.data(), n, b.data(), n);
+        calls++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < 0.02);
+
+    return elapsed / calls;
+}
+
+// smallest size from which `fast` beats `slow` on two consecutive sizes of the sweep
+static size_t find_crossover(multiply_function slow, multiply_function fast, size_t from, size_t to) {
+    int wins = 0;
+    size_t first_win = to;
+    for (size_t n = from; n <= to; n += std::max<size_t>(1, n / 8)) {
+        double t_slow = time_per_call(slow, n), t_fast = time_per_call(fast, n);
+        std::printf("  %6zu limbs: %.3e s vs %.3e s\n", n, t_slow, t_fast);
+        if (t_fast < t_slow) {
+            if (wins++ == 0)
+                first_win = n;
+            if (wins == 2)
+                return first_win;
+        } else wins = 0;
+    }
+
+    return to;
+}
+
+int main() {
+    const size_t never = (size_t) 1 << 40;
+    MultiplicationThresholds t = {never, never, never, never};
+    set_multiplication_thresholds(t);
+
+    std::printf("schoolbook vs Karatsuba\n");
+    t.karatsuba = find_crossover(multiply_schoolbook, multiply_karatsuba, 8, 256);
+    set_multiplication_thresholds(t);
+
+    std::printf("schoolbook vs Karatsuba squaring\n");
+    t.karatsuba_square = find_crossover(schoolbook_square, karatsuba_square, 8, 256);
+    set_multiplication_thresholds(t);
+
+    std::printf("Karatsuba vs Toom-3\n");
+    t.toom3 = find_crossover(multiply_karatsuba, multiply_toom3, 3 * t.karatsuba, 2048);
+    set_multiplication_thresholds(t);
+
+    std::printf("Toom-3 vs NTT\n");
+    t.ntt = find_crossover(multiply_limbs, multiply_ntt, t.toom3, 32768);
+    set_multiplication_thresholds(t);
+
+    std::printf("\nMultiplicationThresholds t = {%zu, %zu, %zu, %zu};\n",
+                t.karatsuba, t.karatsuba_square, t.toom3, t.ntt);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Counts the heap allocations of the hot paths with a replaced operator new and fails if any path allocates more than
+// its bound: words stay inline, the compound operators reuse their buffers, and gcd, powers and Pollard rho allocate
+// a bounded number of times per call instead of once per step. The bounds leave room over today's counts: they catch
+// a loop that starts allocating per iteration, not a single extra allocation.
+//
+//   build/tests/allocations
+//
+// Exits with 1 and prints the offending counts if a bound is exceeded.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include "NumberTheory.h"
+
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+static int failures = 0;
+
+// allocations of one call of f, after a first call that fills the per-thread buffers
+template<class F>
+static size_t count_allocations(F f) {
+    f();
+    size_t before = allocations.load(std::memory_order_relaxed);
+    f();
+    return allocations.load(std::memory_order_relaxed) - before;
+}
+
+template<class F>
+static void expect_at_most(const char *what, size_t bound, F f) {
+    size_t count = count_allocations(f);
+    std::printf("%-55s %8zu allocations (at most %zu)\n", what, count, bound);
+    if (count > bound)
+        failures++;
+}
+
+int main() {
+    volatile long long sink = 0;
+
+    expect_at_most("arithmetic on words", 0, [&]() {
+        BigInt a = 1234567, b = 89, m = 1000000007;
+        for (int i = 0; i < 1000; ++i) {
+            a = (a * b + BigInt(i)) % m;
+            b = gcd(a, b) + b / 3 - (a < b ? 1 : 2);
+        }
+        sink = sink + a.get_sign() + b.get_sign();
+    });
+
+    BigInt x("123456789012345678901234567890123456789012345678901234567890"), y("987654321098765432109876543210987");
+    BigInt a = x;
+    expect_at_most("compound operators on multi-limb operands, 1000 steps", 0, [&]() {
+        for (int i = 0; i < 1000; ++i) {
+            a *= x;
+            a += y;
+            a %= y;
+            a <<= 70;
+            a >>= 3;
+        }
+        sink = sink + a.get_sign();
+    });
+
+    expect_at_most("gcd of a 60-digit and a 33-digit number", 8, [&]() { sink = sink + gcd(x, y).get_sign(); });
+
+    BigInt base("31415926535897932384626433832795028841"), exponent = (BigInt(1) << 100) - 3;
+    BigInt modulus("170141183460469231731687303715884105727"), big_modulus = modulus * modulus * modulus * modulus * 3;
+    expect_at_most("big_pow_modulo with a 100-bit exponent", 8,
+                   [&]() { sink = sink + big_pow_modulo(base, exponent, modulus).get_sign(); });
+    expect_at_most("big_pow_modulo modulo 510 bits", 64,
+                   [&]() { sink = sink + big_pow_modulo(base, exponent, big_modulus).get_sign(); });
+
+    set_factorization_threads(1);
+    expect_at_most("Pollard rho on 1000000016000000063", 100,
+                   [&]() { sink = sink + get_divider_PollardRho(BigInt("1000000016000000063")).get_sign(); });
+
+    std::printf("%d bounds exceeded\n", failures);
+    return failures == 0 ? 0 : 1;
+}
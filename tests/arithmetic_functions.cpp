@@ -0,0 +1,107 @@
+// The segmented sieve of arithmetic functions against trial division over ranges that start at an offset and cross
+// segment boundaries, and the Mertens function and totient sums against prefix sums of the brute-force values and
+// against published values past one block of the summatory sieve.
+//
+//   build/tests/arithmetic_functions [seed]
+//
+// Exits with 1 and prints the failing arguments if any value differs.
+
+#include <algorithm>
+#include <vector>
+#include "ArithmeticFunctions.h"
+#include "check.h"
+
+using test::check;
+
+// the functions of n by trial division
+struct Values {
+    uint64_t smallest_prime_factor = 1, phi = 1;
+    int mu = 1;
+    uint32_t tau = 1;
+    double_limb_t sigma = 1;
+};
+
+static Values brute_force(uint64_t n, int k) {
+    Values v;
+    for (uint64_t d = 2; n > 1; d += d == 2 ? 1 : 2) {
+        if (d * d > n)
+            d = n;
+        if (n % d != 0)
+            continue;
+        if (v.smallest_prime_factor == 1)
+            v.smallest_prime_factor = d;
+
+        int e = 0;
+        double_limb_t d_k = 1, term = 1, sum = 1;
+        for (int i = 0; i < k; ++i)
+            d_k *= d;
+        while (n % d == 0) {
+            n /= d;
+            ++e;
+            v.phi *= e == 1 ? d - 1 : d;
+            sum += term *= d_k;
+        }
+        v.mu = e > 1 ? 0 : -v.mu;
+        v.tau *= e + 1;
+        v.sigma *= sum;
+    }
+    return v;
+}
+
+static void check_range(uint64_t low, uint64_t high, int k) {
+    auto table = sieve_arithmetic_functions(low, high, SMALLEST_PRIME_FACTOR | EULER_PHI | MOBIUS | DIVISOR_COUNT |
+                                                       DIVISOR_SUM, k);
+    for (uint64_t n = low; n < high; ++n) {
+        Values v = brute_force(n, k);
+        size_t i = n - low;
+        check(table.smallest_prime_factor[i] == v.smallest_prime_factor, "smallest_prime_factor", (long long) n);
+        check(table.Euler_phi[i] == v.phi, "Euler_phi", (long long) n);
+        check(table.Mobius[i] == v.mu, "Mobius", (long long) n);
+        check(table.divisor_count[i] == v.tau, "divisor_count", (long long) n);
+        check(table.divisor_sum[i] == v.sigma, "divisor_sum", (long long) n, k);
+    }
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+
+    check_range(1, 3000, 1);
+    check_range(100012345, 100012345 + 2 * ARITHMETIC_SEGMENT + 100, 1);
+    check_range((1ULL << 40) - 300, (1ULL << 40) + 300, 2);
+    check_range(999999000, 1000001000, 0);
+
+    // the sieve hands segments to a consumer in no particular order, together they cover the range once
+    std::vector<int> covered(5 * ARITHMETIC_SEGMENT);
+    sieve_arithmetic_functions(7, 7 + covered.size(), MOBIUS, [&](const ArithmeticTable &segment) {
+        for (uint64_t n = segment.low; n < segment.high; ++n)
+            covered[n - 7]++;
+    });
+    check(std::count(covered.begin(), covered.end(), 1) == (long) covered.size(), "segments cover the range");
+
+    // prefix sums of the brute-force values
+    const uint64_t limit = 2000000;
+    std::vector<long long> Mertens(limit + 1);
+    std::vector<double_limb_t> Phi(limit + 1);
+    for (uint64_t n = 1; n <= limit; ++n) {
+        Values v = brute_force(n, 0);
+        Mertens[n] = Mertens[n - 1] + v.mu;
+        Phi[n] = Phi[n - 1] + v.phi;
+    }
+    std::vector<uint64_t> arguments;
+    for (uint64_t x = 0; x <= 2000; ++x)
+        arguments.push_back(x);
+    for (int i = 0; i < 200; ++i)
+        arguments.push_back(test::rng() % limit + 1);
+    arguments.push_back(limit);
+    for (uint64_t x : arguments) {
+        check(Mertens_function(x) == Mertens[x], "Mertens_function", (long long) x);
+        check(totient_sum(x) == BigInt(std::vector<limb_t>{(limb_t) Phi[x], (limb_t) (Phi[x] >> 64)}, 1),
+              "totient_sum", (long long) x);
+    }
+
+    // x^(2/3) is past SUMMATORY_BLOCK, so the middle values come from two blocks
+    check(Mertens_function(10000000000) == -33722, "Mertens_function", 10000000000LL);
+    check(totient_sum(10000000000) == BigInt("30396355092886216366"), "totient_sum", 10000000000LL);
+
+    return test::finish();
+}
@@ -0,0 +1,101 @@
+// Bernstein's batch gcd: batch_gcd and batch_gcd_file against pairwise gcds, on products of two distinct primes of
+// which some are planted in several moduli, for counts that give odd tree levels, a single modulus and duplicates.
+//
+//   build/tests/batch_gcd [seed]
+//
+// Exits with 1 and prints the modulus whose gcd with the others is wrong.
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "BatchGCD.h"
+#include "NumberTheory.h"
+#include "Serialization.h"
+#include "check.h"
+
+using test::check;
+
+static BigInt random_prime(size_t bits) {
+    for (;;) {
+        BigInt p = test::random_odd(bits);
+        if (is_prime(p))
+            return p;
+    }
+}
+
+// count products of two distinct primes, a shared prime planted in about every eighth one
+static std::vector<BigInt> random_moduli(size_t count, size_t bits) {
+    std::vector<BigInt> planted = {random_prime(bits), random_prime(bits), random_prime(bits)}, moduli;
+    while (moduli.size() < count) {
+        BigInt p = test::rng() % 8 == 0 ? planted[test::rng() % planted.size()] : random_prime(bits);
+        BigInt q = random_prime(bits + 3);
+        moduli.push_back(p * q);
+    }
+    if (count > 4)
+        moduli[count / 2] = moduli[1]; // a duplicate shares both primes
+    return moduli;
+}
+
+// gcd(n_i, product of the others) as the lcm of the pairwise gcds, which are equal for square-free moduli
+static std::vector<BigInt> pairwise(const std::vector<BigInt> &moduli) {
+    std::vector<BigInt> result;
+    for (size_t i = 0; i < moduli.size(); ++i) {
+        BigInt g = 1;
+        for (size_t j = 0; j < moduli.size(); ++j)
+            if (j != i) {
+                BigInt d = gcd(moduli[i], moduli[j]);
+                g = g / gcd(g, d) * d;
+            }
+        result.push_back(g);
+    }
+    return result;
+}
+
+static void check_file(const std::vector<BigInt> &moduli, const std::vector<BigInt> &expected,
+                       const std::filesystem::path &directory) {
+    std::string input = (directory / "moduli.bin").string(), output = (directory / "gcds.bin").string();
+    {
+        std::ofstream out(input, std::ios::binary);
+        BigIntWriter writer(out);
+        for (auto &n : moduli)
+            writer.write(n);
+    }
+    batch_gcd_file(input, output, directory.string());
+
+    std::ifstream in(output, std::ios::binary);
+    BigIntReader reader(in);
+    std::vector<BigInt> result;
+    for (BigInt g; reader.read(g);)
+        result.push_back(g);
+    check(result == expected, "batch_gcd_file", (long long) moduli.size());
+
+    // only the input and the output are left of the level files
+    size_t files = 0;
+    for ([[maybe_unused]] auto &entry : std::filesystem::directory_iterator(directory))
+        ++files;
+    check(files == 2, "level files removed", (long long) files);
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+    auto directory = std::filesystem::temp_directory_path() / ("bigint_batch_gcd_" + std::to_string(test::rng()));
+    std::filesystem::create_directories(directory);
+
+    check(batch_gcd({}).empty(), "batch_gcd of no moduli");
+    set_factorization_threads(3);
+    for (size_t count : {1, 2, 3, 5, 8, 33, 300})
+        for (size_t bits : {30, 100}) {
+            auto moduli = random_moduli(count, bits);
+            auto expected = pairwise(moduli), result = batch_gcd(moduli);
+            check(result.size() == moduli.size(), "batch_gcd size", (long long) count);
+            for (size_t i = 0; i < result.size() && i < moduli.size(); ++i)
+                check(result[i] == expected[i], "batch_gcd", moduli[i], result[i]);
+            check_file(moduli, expected, directory);
+        }
+
+    std::filesystem::remove_all(directory);
+    return test::finish();
+}
@@ -0,0 +1,52 @@
+// Shared helpers of the tests: a seeded generator, random operands and failure reporting. A test calls check for every
+// comparison and returns finish() from main, which prints the number of failures and gives the exit code:
+//
+//   build/tests/<test> [seed]
+
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "BigMath.h"
+
+namespace test {
+
+inline std::mt19937_64 rng;
+inline int failures = 0;
+
+inline void seed(int argc, char **argv) {
+    rng.seed(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+}
+
+// prints the first failures with their operands in hexadecimal
+inline void check(bool ok, const char *what, const BigInt &a = 0, const BigInt &b = 0) {
+    if (!ok && ++failures <= 10)
+        std::printf("FAILED %s\n  a = %s\n  b = %s\n", what, a.to_string(16).c_str(), b.to_string(16).c_str());
+}
+
+// uniform in [0, 2^bits)
+inline BigInt random_bits(size_t bits) {
+    std::vector<limb_t> limbs((bits + LIMB_BITS - 1) / LIMB_BITS);
+    for (auto &x : limbs)
+        x = rng();
+    if (bits % LIMB_BITS != 0)
+        limbs.back() >>= LIMB_BITS - bits % LIMB_BITS;
+    while (!limbs.empty() && limbs.back() == 0)
+        limbs.pop_back();
+    return BigInt(std::move(limbs), 1);
+}
+
+// exactly bits bits and odd
+inline BigInt random_odd(size_t bits) {
+    BigInt a = random_bits(bits - 1) + (BigInt(1) << (int) (bits - 1));
+    return a % 2 == 0 ? a + 1 : a;
+}
+
+inline int finish() {
+    std::printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
+
+}
@@ -0,0 +1,141 @@
+// The Chinese remainder theorem: CRTBasis over pairwise coprime moduli on both of its paths, Garner's for up to
+// GARNER_MODULI moduli and the subproduct tree above, and solve_congruences on moduli with common factors against
+// exhaustive search, inconsistent systems included.
+//
+//   build/tests/crt [seed]
+//
+// Exits with 1 and prints the failing system if any solution is wrong.
+
+#include <string>
+#include <vector>
+#include "CRT.h"
+#include "NumberTheory.h"
+#include "check.h"
+
+using test::check;
+
+// x in [0, modulus) with x = residues[i] (mod moduli[i]) for every i
+static bool solves(const BigInt &x, const BigInt &modulus, const std::vector<BigInt> &residues,
+                   const std::vector<BigInt> &moduli) {
+    bool ok = x >= 0 && x < modulus;
+    for (size_t i = 0; i < moduli.size(); ++i)
+        ok = ok && (x - residues[i]) % moduli[i] == 0;
+    return ok;
+}
+
+// n pairwise coprime moduli of up to bits bits, with 1 and prime powers among them
+static std::vector<BigInt> coprime_moduli(size_t n, size_t bits) {
+    std::vector<BigInt> moduli;
+    while (moduli.size() < n) {
+        BigInt m = test::rng() % 8 == 0 ? BigInt(1) : test::rng() % 8 == 1 ? big_pow(test::rng() % 50 + 2, 3)
+                                                                            : test::random_bits(bits) + 2;
+        bool coprime = true;
+        for (auto &other : moduli)
+            coprime = coprime && gcd(m, other) == 1;
+        if (coprime)
+            moduli.push_back(m);
+    }
+    return moduli;
+}
+
+// residues of either sign, also beyond their moduli
+static std::vector<BigInt> random_residues(const std::vector<BigInt> &moduli) {
+    std::vector<BigInt> residues;
+    for (auto &m : moduli) {
+        BigInt r = test::random_bits(m.get_limbs().size() * LIMB_BITS + 8);
+        residues.push_back(test::rng() % 2 ? r : 0 - r);
+    }
+    return residues;
+}
+
+static void check_basis(size_t n, size_t bits) {
+    auto moduli = coprime_moduli(n, bits);
+    CRTBasis basis(moduli);
+    BigInt product = 1;
+    for (auto &m : moduli)
+        product *= m;
+    check(basis.get_modulus() == product && basis.get_moduli() == moduli, "CRTBasis moduli", (long long) n);
+
+    for (int i = 0; i < 5; ++i) {
+        auto residues = random_residues(moduli);
+        check(solves(basis.solve(residues), product, residues, moduli), "CRTBasis::solve", (long long) n, product);
+
+        BigInt modulus;
+        BigInt x = solve_congruences(residues, moduli, &modulus);
+        check(modulus == product && solves(x, product, residues, moduli), "solve_congruences of coprime moduli",
+              (long long) n, product);
+    }
+}
+
+// small moduli with common factors: the least x >= 0 or none, by trying every x below their lcm
+static void check_against_exhaustive_search() {
+    for (int i = 0; i < 500; ++i) {
+        size_t n = test::rng() % 4 + 1;
+        std::vector<BigInt> moduli, residues;
+        long long lcm = 1;
+        for (size_t j = 0; j < n; ++j) {
+            long long m = test::rng() % 36 + 1;
+            moduli.push_back(m);
+            residues.push_back((long long) (test::rng() % 100) - 50);
+            lcm = lcm / gcd(BigInt(lcm), BigInt(m)).get_limbs()[0] * m;
+        }
+
+        long long expected = -1;
+        for (long long x = 0; x < lcm && expected < 0; ++x)
+            if (solves(x, lcm, residues, moduli))
+                expected = x;
+
+        BigInt modulus;
+        try {
+            BigInt x = solve_congruences(residues, moduli, &modulus);
+            check(expected >= 0 && x == expected && modulus == lcm, "solve_congruences", x, expected);
+        } catch (const char *e) {
+            check(expected < 0 && std::string(e) == "CongruencesAreInconsistent", "solve_congruences throws",
+                  expected, lcm);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+
+    // Garner's path up to GARNER_MODULI moduli, the tree above, single-limb and multi-limb moduli
+    for (size_t n : {1, 2, 3, 4, 5, 7, 16, 33, 200})
+        for (size_t bits : {20, 64, 200})
+            check_basis(n, bits);
+
+    check_against_exhaustive_search();
+
+    // large moduli with a common factor: consistent residues of a known x, and one of them broken
+    BigInt common = test::random_odd(100), x = test::random_bits(400);
+    std::vector<BigInt> moduli, residues;
+    for (int i = 0; i < 9; ++i) {
+        moduli.push_back(common * test::random_odd(80) * (i % 3 == 0 ? 4 : 1));
+        residues.push_back(x % moduli.back());
+    }
+    BigInt modulus, solution = solve_congruences(residues, moduli, &modulus);
+    check(solves(solution, modulus, residues, moduli) && solution == x % modulus,
+          "solve_congruences with a common factor", solution, modulus);
+    for (auto &m : moduli)
+        check(modulus % m == 0, "lcm", modulus, m);
+    residues[5] += 1;
+    bool thrown = false;
+    try {
+        solve_congruences(residues, moduli);
+    } catch (const char *) {
+        thrown = true;
+    }
+    check(thrown, "inconsistent congruences");
+
+    thrown = false;
+    try {
+        CRTBasis({6, 35, 10});
+    } catch (const char *e) {
+        thrown = std::string(e) == "ModuliAreNotCoprime";
+    }
+    check(thrown, "CRTBasis of moduli that are not coprime");
+
+    check(CRTH({2, 3, 2}, {3, 5, 7}) == 23 && CRTH({5, 11}, {12, 18}) == 29, "CRTH");
+
+    return test::finish();
+}
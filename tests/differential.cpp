@@ -0,0 +1,450 @@
+// Differential test of BigInt against a slow reference on 32-bit digits. The reference keeps the semantics of the
+// original decimal BigInt: quotients round toward zero, the remainder of a negative dividend a by b is b - (|a| mod |b|)
+// and >> rounds toward zero. Operands run from one limb to past the Toom-3 threshold, with runs of zero and all-ones
+// limbs for the carries. Every check is repeated with lowered thresholds, so that the same sizes go through Karatsuba,
+// Toom-3, the NTT and Newton division.
+//
+//   build/tests/differential [seed]
+//
+// Exits with 1 and prints the failing operands if any result differs.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "Division.h"
+#include "Multiplication.h"
+#include "NumberTheory.h"
+
+namespace reference {
+
+// sign and magnitude in base 2^32, least significant digit first, no leading zero digits, sign 0 for zero
+struct Number {
+    int sign = 0;
+    std::vector<uint32_t> digits;
+};
+
+void normalize(Number &a) {
+    while (!a.digits.empty() && a.digits.back() == 0)
+        a.digits.pop_back();
+    if (a.digits.empty())
+        a.sign = 0;
+}
+
+Number from_BigInt(const BigInt &a) {
+    Number r;
+    for (limb_t limb : a.get_limbs()) {
+        r.digits.push_back((uint32_t) limb);
+        r.digits.push_back((uint32_t) (limb >> 32));
+    }
+    r.sign = a.get_sign();
+    normalize(r);
+    return r;
+}
+
+bool operator==(const Number &a, const Number &b) {
+    return a.sign == b.sign && a.digits == b.digits;
+}
+
+int compare_magnitudes(const Number &a, const Number &b) {
+    if (a.digits.size() != b.digits.size())
+        return a.digits.size() < b.digits.size() ? -1 : 1;
+    for (size_t i = a.digits.size(); i-- > 0;)
+        if (a.digits[i] != b.digits[i])
+            return a.digits[i] < b.digits[i] ? -1 : 1;
+    return 0;
+}
+
+int compare(const Number &a, const Number &b) {
+    if (a.sign != b.sign)
+        return a.sign < b.sign ? -1 : 1;
+    return a.sign >= 0 ? compare_magnitudes(a, b) : compare_magnitudes(b, a);
+}
+
+// |a| + |b| and |a| - |b| for |a| >= |b|, with the given sign
+Number add_magnitudes(const Number &a, const Number &b, int sign) {
+    Number r;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < std::max(a.digits.size(), b.digits.size()); ++i) {
+        carry += (i < a.digits.size() ? a.digits[i] : 0) + (uint64_t) (i < b.digits.size() ? b.digits[i] : 0);
+        r.digits.push_back((uint32_t) carry);
+        carry >>= 32;
+    }
+    r.digits.push_back((uint32_t) carry);
+    r.sign = sign;
+    normalize(r);
+    return r;
+}
+
+Number subtract_magnitudes(const Number &a, const Number &b, int sign) {
+    Number r;
+    int64_t borrow = 0;
+    for (size_t i = 0; i < a.digits.size(); ++i) {
+        int64_t d = (int64_t) a.digits[i] - (i < b.digits.size() ? b.digits[i] : 0) - borrow;
+        borrow = d < 0;
+        r.digits.push_back((uint32_t) d);
+    }
+    r.sign = sign;
+    normalize(r);
+    return r;
+}
+
+Number negate(Number a) {
+    a.sign = -a.sign;
+    return a;
+}
+
+Number add(const Number &a, const Number &b) {
+    if (a.sign == 0) return b;
+    if (b.sign == 0) return a;
+    if (a.sign == b.sign)
+        return add_magnitudes(a, b, a.sign);
+    return compare_magnitudes(a, b) >= 0 ? subtract_magnitudes(a, b, a.sign) : subtract_magnitudes(b, a, b.sign);
+}
+
+Number subtract(const Number &a, const Number &b) {
+    return add(a, negate(b));
+}
+
+Number multiply(const Number &a, const Number &b) {
+    Number r;
+    r.digits.assign(a.digits.size() + b.digits.size() + 1, 0);
+    for (size_t i = 0; i < a.digits.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.digits.size(); ++j) {
+            carry += (uint64_t) a.digits[i] * b.digits[j] + r.digits[i + j];
+            r.digits[i + j] = (uint32_t) carry;
+            carry >>= 32;
+        }
+        r.digits[i + b.digits.size()] = (uint32_t) carry;
+    }
+    r.sign = a.sign * b.sign;
+    normalize(r);
+    return r;
+}
+
+Number shift_left(const Number &a, size_t shift) {
+    Number r;
+    r.digits.assign(shift / 32, 0);
+    uint32_t carry = 0;
+    for (uint32_t d : a.digits) {
+        r.digits.push_back(shift % 32 == 0 ? d : (d << (shift % 32)) | carry);
+        carry = shift % 32 == 0 ? 0 : d >> (32 - shift % 32);
+    }
+    r.digits.push_back(carry);
+    r.sign = a.sign;
+    normalize(r);
+    return r;
+}
+
+Number shift_right(const Number &a, size_t shift) {
+    Number r;
+    for (size_t i = shift / 32; i < a.digits.size(); ++i) {
+        uint64_t pair = a.digits[i] | (i + 1 < a.digits.size() ? (uint64_t) a.digits[i + 1] << 32 : 0);
+        r.digits.push_back((uint32_t) (pair >> (shift % 32)));
+    }
+    r.sign = a.sign;
+    normalize(r);
+    return r;
+}
+
+bool is_even(const Number &a) {
+    return a.digits.empty() || (a.digits[0] & 1) == 0;
+}
+
+// |a| mod |b| by binary long division, for small operands only
+Number modulo(const Number &a, const Number &b) {
+    Number r;
+    for (size_t i = 32 * a.digits.size(); i-- > 0;) {
+        r = shift_left(r, 1);
+        if ((a.digits[i / 32] >> (i % 32)) & 1)
+            r = add(r, Number{1, {1}});
+        if (r.sign != 0 && compare_magnitudes(r, b) >= 0)
+            r = subtract_magnitudes(r, b, 1);
+    }
+    return r;
+}
+
+// binary gcd on the magnitudes
+Number gcd(Number a, Number b) {
+    a.sign = a.sign != 0;
+    b.sign = b.sign != 0;
+    size_t shift = 0;
+    while (a.sign != 0 && b.sign != 0 && is_even(a) && is_even(b))
+        a = shift_right(a, 1), b = shift_right(b, 1), shift++;
+    while (a.sign != 0 && b.sign != 0) {
+        while (is_even(a)) a = shift_right(a, 1);
+        while (is_even(b)) b = shift_right(b, 1);
+        if (compare(a, b) >= 0)
+            a = subtract(a, b);
+        else
+            b = subtract(b, a);
+    }
+    return shift_left(a.sign != 0 ? a : b, shift);
+}
+
+// digits in radix 2^k or by repeated division by 10^9
+std::string to_string(Number a, int radix) {
+    if (a.sign == 0)
+        return "0";
+
+    std::string s;
+    const char *alphabet = "0123456789abcdef";
+    if (radix == 16) {
+        for (uint32_t d : a.digits)
+            for (int k = 0; k < 8; ++k)
+                s.push_back(alphabet[(d >> (4 * k)) & 15]);
+    } else {
+        while (!a.digits.empty()) {
+            uint64_t remainder = 0;
+            for (size_t i = a.digits.size(); i-- > 0;) {
+                uint64_t current = remainder << 32 | a.digits[i];
+                a.digits[i] = (uint32_t) (current / 1000000000);
+                remainder = current % 1000000000;
+            }
+            while (!a.digits.empty() && a.digits.back() == 0)
+                a.digits.pop_back();
+            for (int k = 0; k < 9; ++k, remainder /= 10)
+                s.push_back(alphabet[remainder % 10]);
+        }
+    }
+    while (s.size() > 1 && s.back() == '0')
+        s.pop_back();
+    if (a.sign < 0)
+        s.push_back('-');
+    std::reverse(s.begin(), s.end());
+    return s;
+}
+
+}
+
+using reference::Number;
+
+static std::mt19937_64 rng;
+static int failures = 0;
+
+static void fail(const char *what, const BigInt &a, const BigInt &b) {
+    if (++failures <= 10)
+        std::printf("FAILED %s\n  a = %s\n  b = %s\n", what, a.to_string(16).c_str(), b.to_string(16).c_str());
+}
+
+static void check(bool ok, const char *what, const BigInt &a, const BigInt &b) {
+    if (!ok)
+        fail(what, a, b);
+}
+
+static bool same(const BigInt &a, const Number &b) {
+    return reference::from_BigInt(a) == b;
+}
+
+// random number of the given limbs, with runs of zero and all-ones limbs, random sign
+static BigInt random_number(size_t limbs) {
+    std::vector<limb_t> v(limbs);
+    for (auto &x : v)
+        switch (rng() % 6) {
+            case 0: x = 0; break;
+            case 1: x = ~(limb_t) 0; break;
+            case 2: x = rng() >> (rng() % 64); break;
+            default: x = rng();
+        }
+    if (limbs > 0 && v.back() == 0)
+        v.back() = 1;
+    return BigInt(v, rng() % 2 ? 1 : -1);
+}
+
+static size_t random_size(size_t max_limbs) {
+    const size_t sizes[] = {0, 1, 1, 2, 2, 3, 4, 7, 16, 33, 70, 130, 260};
+    size_t n = sizes[rng() % (sizeof(sizes) / sizeof(sizes[0]))];
+    return std::min(n, max_limbs);
+}
+
+static void check_arithmetic(const BigInt &a, const BigInt &b) {
+    Number ra = reference::from_BigInt(a), rb = reference::from_BigInt(b);
+
+    check(same(a + b, reference::add(ra, rb)), "a + b", a, b);
+    check(same(a - b, reference::subtract(ra, rb)), "a - b", a, b);
+    check(same(a * b, reference::multiply(ra, rb)), "a * b", a, b);
+    check(same(a * a, reference::multiply(ra, ra)), "a * a", a, b);
+    check(same(-a, reference::negate(ra)), "-a", a, b);
+
+    int c = reference::compare(ra, rb);
+    check((a < b) == (c < 0) && (a > b) == (c > 0) && (a == b) == (c == 0) && (a != b) == (c != 0) &&
+          (a <= b) == (c <= 0) && (a >= b) == (c >= 0), "comparison", a, b);
+
+    // the compound operators, also on themselves
+    BigInt x = a;
+    x += b;
+    check(same(x, reference::add(ra, rb)), "a += b", a, b);
+    x = a;
+    x -= b;
+    check(same(x, reference::subtract(ra, rb)), "a -= b", a, b);
+    x = a;
+    x *= b;
+    check(same(x, reference::multiply(ra, rb)), "a *= b", a, b);
+    x = a;
+    x += x;
+    check(same(x, reference::add(ra, ra)), "a += a", a, b);
+    x = a;
+    x -= x;
+    check(x == 0 && x.get_sign() == 0, "a -= a", a, b);
+    x = a;
+    x *= x;
+    check(same(x, reference::multiply(ra, ra)), "a *= a", a, b);
+
+    if (b != 0) {
+        // |a| = |q| |b| + rem with 0 <= rem < |b| pins the quotient down, the remainder follows from the sign of a
+        BigInt q = a / b, r = a % b;
+        Number rq = reference::from_BigInt(q), magnitude_a = ra, magnitude_b = rb, magnitude_q = rq;
+        magnitude_a.sign = ra.sign != 0;
+        magnitude_b.sign = 1;
+        magnitude_q.sign = rq.sign != 0;
+        Number rem = reference::subtract(magnitude_a, reference::multiply(magnitude_q, magnitude_b));
+        check(rem.sign >= 0 && reference::compare_magnitudes(rem, rb) < 0, "|a / b| rounds toward zero", a, b);
+        check(rq.sign == 0 || rq.sign == a.get_sign() * b.get_sign(), "sign of a / b", a, b);
+        Number expected_r = a.get_sign() < 0 && rem.sign != 0 ? reference::subtract(rb, rem) : rem;
+        check(same(r, expected_r), "a % b", a, b);
+
+        BigInt dq, dr;
+        BigInt::divide(a, b, &dq, &dr);
+        check(dq == q && dr == r, "divide", a, b);
+        auto [pq, pr] = div(a, b);
+        check(pq == q && pr == r, "div", a, b);
+        x = a;
+        x /= b;
+        check(x == q, "a /= b", a, b);
+        x = a;
+        x %= b;
+        check(x == r, "a %= b", a, b);
+        x = a;
+        BigInt::divide(x, b, &x, nullptr);
+        check(x == q, "divide into the dividend", a, b);
+    }
+
+    int shift = (int) (rng() % 300);
+    check(same(a << shift, reference::shift_left(ra, shift)), "a << shift", a, b);
+    check(same(a >> shift, reference::shift_right(ra, shift)), "a >> shift", a, b);
+    x = a;
+    x <<= shift;
+    x >>= shift;
+    check(x == a, "a << shift >> shift", a, b);
+
+    check(a.to_string() == reference::to_string(ra, 10), "to_string", a, b);
+    check(a.to_string(16) == reference::to_string(ra, 16), "to_string(16)", a, b);
+    check(BigInt(a.to_string()) == a && BigInt(a.to_string(36), 36) == a, "parse", a, b);
+
+    if (a >= 0) {
+        BigInt s = sqrt(a);
+        Number rs = reference::from_BigInt(s), next = reference::add(rs, Number{1, {1}});
+        check(reference::compare(reference::multiply(rs, rs), ra) <= 0 &&
+              reference::compare(reference::multiply(next, next), ra) > 0, "sqrt", a, b);
+    }
+}
+
+// gcd, inverses and powers on operands small enough for the binary reference
+static void check_modular(const BigInt &a, const BigInt &b) {
+    Number ra = reference::from_BigInt(a), rb = reference::from_BigInt(b);
+    Number g = reference::gcd(ra, rb);
+    check(same(gcd(a, b), g), "gcd", a, b);
+
+    BigInt x, y;
+    BigInt eg = extended_gcd(a, b, x, y);
+    check(same(eg, g) && a * x + b * y == eg, "extended_gcd", a, b);
+
+    BigInt m = abs(b);
+    if (m < 2)
+        return;
+    Number rm = reference::from_BigInt(m);
+    if (g == Number{1, {1}}) {
+        BigInt inverse = inverse_modulo(a, m);
+        // |x a| is 1 or m - 1 modulo m by the sign of a
+        Number product = reference::multiply(reference::from_BigInt(inverse), ra);
+        Number expected = product.sign < 0 ? reference::subtract(rm, Number{1, {1}}) : Number{1, {1}};
+        product.sign = product.sign != 0;
+        check(inverse >= 0 && inverse < m && reference::modulo(product, rm) == expected, "inverse_modulo", a, b);
+    }
+
+    // a^e mod m by square and multiply on the reference, the result in [0, m) for a >= 0
+    BigInt base = abs(a), e = random_number(1 + rng() % 2);
+    Number rbase = reference::from_BigInt(base), power{1, {1}};
+    for (size_t i = 32 * reference::from_BigInt(e).digits.size(); i-- > 0;) {
+        power = reference::modulo(reference::multiply(power, power), rm);
+        if ((reference::from_BigInt(e).digits[i / 32] >> (i % 32)) & 1)
+            power = reference::modulo(reference::multiply(power, rbase), rm);
+    }
+    check(same(big_pow_modulo(base, e, m), power), "big_pow_modulo", base, m);
+    if (m.get_limbs()[0] & 1)
+        check(same(big_pow_modulo_constant_time(base, e, m), power), "big_pow_modulo_constant_time", base, m);
+}
+
+static void run(int iterations) {
+    for (int i = 0; i < iterations; ++i) {
+        BigInt a = random_number(random_size(260)), b = random_number(random_size(260));
+        check_arithmetic(a, b);
+        check_arithmetic(b, a);
+    }
+    for (int i = 0; i < iterations; ++i) {
+        BigInt a = random_number(random_size(4)), b = random_number(random_size(4));
+        check_modular(a, b);
+    }
+}
+
+// fixed results of the number theory routines, worked out independently of this library
+static void check_number_theory() {
+    const char *primes[] = {"2", "3", "1000000007", "18446744073709551557", "170141183460469231731687303715884105727",
+                            "57896044618658097711785492504343953926634992332820282019728792003956564819949"};
+    const char *composites[] = {"1", "561", "3215031751", "341550071728321", "3825123056546413051",
+                                "318665857834031151167461", "18446744073709551617",
+                                "170141183460469231731687303715884105729"};
+    for (const char *p : primes)
+        check(is_prime(BigInt(p)) && Miller_Rabin_test(BigInt(p), 10), "is_prime of a prime", BigInt(p), 0);
+    for (const char *n : composites)
+        check(!is_prime(BigInt(n)), "is_prime of a composite", BigInt(n), 0);
+
+    struct Factorization {
+        const char *n;
+        std::vector<const char *> factors;
+    };
+    const Factorization factorizations[] = {
+        {"1000000016000000063", {"1000000007", "1000000009"}},
+        {"18446744073709551617", {"274177", "67280421310721"}},
+        {"147573952589676412927", {"193707721", "761838257287"}},
+        {"600851475143", {"71", "839", "1471", "6857"}},
+        {"1048576", std::vector<const char *>(20, "2")},
+    };
+    for (auto &f : factorizations) {
+        auto factors = factorization(BigInt(f.n));
+        std::sort(factors.begin(), factors.end(), [](const BigInt &a, const BigInt &b) { return a < b; });
+        bool ok = factors.size() == f.factors.size();
+        for (size_t i = 0; ok && i < factors.size(); ++i)
+            ok = factors[i] == BigInt(f.factors[i]);
+        check(ok, "factorization", BigInt(f.n), 0);
+    }
+
+    check(Euler_function(BigInt("600851475143")) == BigInt("591194251200"), "Euler_function", 600851475143LL, 0);
+    check(Mobius_function(BigInt(30)) == -1 && Mobius_function(BigInt(12)) == 0, "Mobius_function", 30, 12);
+    check(Jacobi_symbol(1001, 9907) == -1 && Legendre_symbol(2, 1000000007) == 1, "Jacobi_symbol", 1001, 9907);
+    check(discrete_logarithm(3, 13, 17) == 4 && discrete_logarithm(2, 3, 7) == -1, "discrete_logarithm", 3, 13);
+    check(CRTH({2, 3, 2}, {3, 5, 7}) == 23, "CRTH", 23, 0);
+}
+
+int main(int argc, char **argv) {
+    rng.seed(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+
+    run(150);
+
+    // the same sizes through the fast multiplications and Newton division
+    auto thresholds = get_multiplication_thresholds();
+    size_t newton = get_newton_division_threshold();
+    set_multiplication_thresholds({4, 4, 8, 24});
+    set_newton_division_threshold(6);
+    run(150);
+    set_multiplication_thresholds(thresholds);
+    set_newton_division_threshold(newton);
+
+    check_number_theory();
+
+    std::printf("%d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
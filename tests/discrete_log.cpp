@@ -0,0 +1,114 @@
+// Discrete logarithms: discrete_logarithm against exhaustive search over small moduli, so that missing solutions are
+// checked as well as found ones, then g^x = h for random instances of every method on sizes past the table of
+// baby-step giant-step, where rho and the kangaroos walk.
+//
+//   build/tests/discrete_log [seed]
+//
+// Exits with 1 and prints the failing instance if any logarithm is wrong.
+
+#include "DiscreteLog.h"
+#include "NumberTheory.h"
+#include "check.h"
+
+using test::check;
+
+static BigInt random_below(const BigInt &n) {
+    return test::random_bits(n.get_limbs().size() * LIMB_BITS + 64) % n;
+}
+
+// a prime q of the given bits with p = 2 q + 1 prime
+static BigInt safe_prime_subgroup(size_t bits) {
+    for (;;) {
+        BigInt q = test::random_odd(bits);
+        if (is_prime(q) && is_prime(2 * q + 1))
+            return q;
+    }
+}
+
+// the smallest x >= 0 with a^x = b (mod m) by trying every x up to the order of a, -1 if there is none
+static long long exhaustive_logarithm(long long a, long long b, long long m) {
+    long long power = 1 % m;
+    for (long long x = 0; x <= m; ++x) {
+        if (power == b % m)
+            return x;
+        power = power * a % m;
+        if (power == 1 % m)
+            break;
+    }
+    return -1;
+}
+
+static void check_small_moduli() {
+    const long long moduli[] = {2, 3, 4, 8, 9, 16, 25, 27, 64, 97, 101, 121, 243, 256, 343, 1024, 1009, 2187, 3125,
+                                4096, 6561, 7919, 12, 15, 35, 60, 105, 210, 1001, 2310, 4199, 9991, 3 * 1024, 125 * 49};
+    for (long long m : moduli)
+        for (int i = 0; i < 60; ++i) {
+            long long a = test::rng() % m, b = test::rng() % m;
+            if (gcd(BigInt(a), BigInt(m)) != 1)
+                continue;
+            long long expected = exhaustive_logarithm(a, b, m);
+            check(discrete_logarithm(a, b, m) == expected, "discrete_logarithm", a, b);
+        }
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+
+    check_small_moduli();
+
+    // random x modulo a prime with a smooth group order, a prime power, a composite and 2^127 - 1
+    const char *moduli[] = {"2305843009213693951", "1000009000027000027", "1000073001431003663",
+                            "170141183460469231731687303715884105727"};
+    for (const char *text : moduli) {
+        BigInt m(text), g = 3, x = random_below(m), h = big_pow_modulo(g, x, m);
+        BigInt y = discrete_logarithm(g, h, m);
+        check(y >= 0 && big_pow_modulo(g, y, m) == h, "discrete_logarithm", m, x);
+    }
+    check(discrete_logarithm(4, 3, 7) == -1, "no logarithm", 4, 3);
+
+    // Pohlig-Hellman in the whole group modulo 2^61 - 1, whose order 2 3^2 5^2 7 11 13 31 41 61 151 331 1321 is smooth
+    BigInt p("2305843009213693951");
+    ModContext context(p);
+    BigInt order = p - 1;
+    ModInt g(context, 37); // a primitive root
+    for (int i = 0; i < 5; ++i) {
+        BigInt x = random_below(order);
+        ModInt h = context.pow(g, x);
+        BigInt y = discrete_logarithm_Pohlig_Hellman(g, h, order, factorize(order));
+        check(y >= 0 && context.pow(g, y) == h, "discrete_logarithm_Pohlig_Hellman", x, y);
+    }
+    // a primitive root is not a power of its square, of order (p - 1) / 2
+    BigInt half = order / 2;
+    check(discrete_logarithm_Pohlig_Hellman(g * g, g, half, factorize(half)) == -1,
+          "discrete_logarithm_Pohlig_Hellman without a logarithm");
+
+    // baby-step giant-step finds the smallest x below the bound
+    for (int i = 0; i < 5; ++i) {
+        BigInt bound = test::rng() % 100000000 + 1, x = random_below(bound);
+        ModInt h = context.pow(g, x);
+        check(discrete_logarithm_BSGS(g, h, bound) == x, "discrete_logarithm_BSGS", x, bound);
+        check(discrete_logarithm_BSGS(g, context.pow(g, bound + x), bound) == -1, "discrete_logarithm_BSGS outside",
+              x, bound);
+    }
+
+    // rho in the subgroup of prime order q of a safe prime, past the baby-step table
+    set_factorization_threads(2);
+    BigInt q = safe_prime_subgroup(44);
+    ModContext safe(2 * q + 1);
+    ModInt generator(safe, 4);
+    for (int i = 0; i < 2; ++i) {
+        BigInt x = random_below(q);
+        check(discrete_logarithm_rho(generator, safe.pow(generator, x), q) == x, "discrete_logarithm_rho", q, x);
+    }
+
+    // kangaroos in an interval of 2^42 and a short one that baby-step giant-step covers
+    for (BigInt width : {(BigInt(1) << 42) + 5, BigInt(1000000)}) {
+        BigInt lower = random_below(order - width), x = lower + random_below(width + 1);
+        BigInt y = discrete_logarithm_kangaroo(g, context.pow(g, x), lower, lower + width);
+        check(y >= lower && y <= lower + width && context.pow(g, y) == context.pow(g, x),
+              "discrete_logarithm_kangaroo", x, y);
+    }
+    check(discrete_logarithm_kangaroo(g, context.pow(g, 5000), 0, 1000) == -1, "kangaroo outside the interval");
+
+    return test::finish();
+}
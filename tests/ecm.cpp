@@ -0,0 +1,45 @@
+// Lenstra's elliptic curve method: the curves of get_divider_ECM, whose sigmas are fixed by the bounds and the curve
+// number, recover known 15- and 18-digit prime factors of a number with a 25-digit cofactor, return n for a prime, and
+// factorization_PollardRho escalates to them when rho stalls on an 18-digit factor.
+//
+//   build/tests/ecm
+//
+// Exits with 1 and prints the number if a factor is missed.
+
+#include <algorithm>
+#include "ECM.h"
+#include "NumberTheory.h"
+#include "check.h"
+
+using test::check;
+
+int main() {
+    BigInt p15("100000000012397"), p18("100000000000012373"), p22("1000000000000000012501");
+    BigInt p25("1000000000000000000012369");
+
+    // one thread runs the curves in order, so the curve that finds the factor is always the same
+    set_factorization_threads(1);
+    check(get_divider_ECM(p15 * p25, get_ECM_parameters(15)) == p15, "15-digit factor", p15 * p25);
+    check(get_divider_ECM(p18 * p25, get_ECM_parameters(20)) == p18, "18-digit factor", p18 * p25);
+
+    ECMParameters few;
+    few.b1 = 2000;
+    few.curves = 8;
+    check(get_divider_ECM(p25, few) == p25, "prime", p25);
+
+    // any curve of several threads may win, its divider is proper
+    set_factorization_threads(4);
+    BigInt d = get_divider_ECM(p15 * p25, get_ECM_parameters(15));
+    check(d != 1 && d != p15 * p25 && (p15 * p25) % d == 0, "divider from several threads", p15 * p25, d);
+
+    // rho gives up on an 18-digit factor after 2^18 steps, the first ECM levels find it
+    set_factorization_threads(1);
+    auto factors = factorization_PollardRho(p18 * p22);
+    std::sort(factors.begin(), factors.end(), [](const BigInt &a, const BigInt &b) { return a < b; });
+    check(factors == std::vector<BigInt>{p18, p22}, "factorization_PollardRho escalating to ECM", p18 * p22);
+
+    check(get_ECM_parameters(15).b1 == 2000 && get_ECM_parameters(20).b1 == 11000 &&
+          get_ECM_parameters(100).b1 == get_ECM_parameters(45).b1, "get_ECM_parameters");
+
+    return test::finish();
+}
@@ -0,0 +1,152 @@
+// The factorization cache and batches: factorize and factorize_batch against factorization_PollardRho, the LRU order
+// of the cache and its capacity, told apart by the Miller-Rabin rounds that only a miss runs, and threads that
+// factorize the same numbers while the capacity changes. Built with BIGINT_INSTRUMENTATION for those counters.
+//
+//   build/tests/factorization [seed]
+//
+// Exits with 1 and prints the number whose factorization is wrong or whose lookup missed or hit.
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "Factorization.h"
+#include "Instrumentation.h"
+#include "NumberTheory.h"
+#include "check.h"
+
+using test::check;
+
+#ifndef BIGINT_INSTRUMENTATION
+#error "the factorization test needs BIGINT_INSTRUMENTATION"
+#endif
+
+static BigInt random_prime(size_t bits) {
+    for (;;) {
+        BigInt p = test::random_odd(bits);
+        if (is_prime(p))
+            return p;
+    }
+}
+
+// 1, primes, prime powers, smooth numbers and products of up to four 32-bit primes
+static std::vector<BigInt> random_numbers(size_t count) {
+    std::vector<BigInt> numbers = {1, 2, 4, 1024, BigInt(65537) * 65537 * 65537 * 3};
+    while (numbers.size() < count) {
+        BigInt n = 1;
+        for (int factors = test::rng() % 4 + 1; factors > 0; --factors) {
+            bool small = test::rng() % 3 == 0;
+            n *= small ? BigInt((long long) (test::rng() % 1000 + 2)) : random_prime(test::rng() % 24 + 9);
+        }
+        numbers.push_back(n);
+    }
+    return numbers;
+}
+
+// the prime powers of the primes of factorization_PollardRho
+static Factorization expected_factorization(const BigInt &n) {
+    Factorization result;
+    if (n == 1)
+        return result;
+    auto primes = factorization_PollardRho(n);
+    std::sort(primes.begin(), primes.end());
+    for (size_t i = 0; i < primes.size(); ++i) {
+        if (i == 0 || primes[i] != primes[i - 1])
+            result.push_back({primes[i], 0});
+        result.back().exponent++;
+    }
+    return result;
+}
+
+static bool equal(const Factorization &a, const Factorization &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const PrimePower &x, const PrimePower &y) {
+        return x.prime == y.prime && x.exponent == y.exponent;
+    });
+}
+
+// whether factorize(n) factored n instead of finding it in the cache
+static bool factored(const BigInt &n) {
+    reset_instrumentation();
+    factorize(n);
+    return get_instrumentation_snapshot().total(MILLER_RABIN_ROUNDS) != 0;
+}
+
+static void check_cache() {
+    set_factorization_threads(1);
+    BigInt a = random_prime(30) * random_prime(31), b = random_prime(30) * random_prime(32);
+    BigInt c = random_prime(30) * random_prime(33), d = random_prime(30) * random_prime(34);
+
+    set_factorization_cache_capacity(0);
+    check(factored(a) && factored(a), "no cache at capacity 0", a);
+
+    set_factorization_cache_capacity(3);
+    check(get_factorization_cache_capacity() == 3, "get_factorization_cache_capacity");
+    check(factored(a) && factored(b) && factored(c), "first factorizations", a);
+    check(!factored(a), "hit", a); // a is the most recent, b the least recent
+    check(factored(d), "miss", d);
+    check(factored(b), "least recently used evicted", b); // which evicts c
+    check(!factored(a) && !factored(d) && !factored(b), "kept", a);
+    check(factored(c), "second eviction", c); // which evicts a
+
+    // shrinking keeps the most recent
+    set_factorization_cache_capacity(1);
+    check(!factored(c), "kept when shrinking", c);
+    check(factored(d), "evicted when shrinking", d);
+    set_factorization_cache_capacity(4096);
+}
+
+// threads that factorize the same numbers in different orders while the cache keeps a few and changes size
+static void check_threads(const std::vector<BigInt> &numbers, const std::vector<Factorization> &expected) {
+    set_factorization_threads(2);
+    set_factorization_cache_capacity(5);
+    std::vector<int> wrong(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < wrong.size(); ++t)
+        threads.emplace_back([&, t]() {
+            for (size_t round = 0; round < 3; ++round)
+                for (size_t j = 0; j < numbers.size(); ++j) {
+                    size_t i = (j * (2 * t + 1) + round) % numbers.size();
+                    wrong[t] += !equal(factorize(numbers[i]), expected[i]);
+                    if (t == 0 && j % 16 == 0)
+                        set_factorization_cache_capacity(j % 32 == 0 ? 2 : 9);
+                }
+        });
+    for (auto &thread : threads)
+        thread.join();
+    for (size_t t = 0; t < wrong.size(); ++t)
+        check(wrong[t] == 0, "factorize from several threads", (long long) t, wrong[t]);
+    set_factorization_cache_capacity(4096);
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+    auto numbers = random_numbers(60);
+    std::vector<Factorization> expected;
+    for (auto &n : numbers)
+        expected.push_back(expected_factorization(n));
+
+    for (unsigned threads : {1, 4}) {
+        set_factorization_cache_capacity(0);
+        set_factorization_threads(threads);
+        auto batch = factorize_batch(numbers);
+        check(batch.size() == numbers.size(), "factorize_batch size", (long long) threads);
+        for (size_t i = 0; i < batch.size() && i < numbers.size(); ++i)
+            check(equal(batch[i], expected[i]), "factorize_batch", numbers[i], (long long) threads);
+    }
+    set_factorization_cache_capacity(4096);
+    for (size_t i = 0; i < numbers.size(); ++i)
+        check(equal(factorize(numbers[i]), expected[i]) && equal(factorize(numbers[i]), expected[i]), "factorize",
+              numbers[i]);
+
+    bool thrown = false;
+    try {
+        factorize_batch(std::vector<BigInt>{6, 0});
+    } catch (const char *) {
+        thrown = true;
+    }
+    check(thrown, "factorize_batch of 0");
+
+    check_cache();
+    check_threads(numbers, expected);
+
+    return test::finish();
+}
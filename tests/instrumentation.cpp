@@ -0,0 +1,219 @@
+// The counters and timers of Instrumentation.h, built with BIGINT_INSTRUMENTATION: every counter moves when its code
+// runs, word-sized gcds are counted like the others, counts of ended threads survive them, reset clears everything, and
+// to_JSON and to_Prometheus give well-formed text.
+//
+//   build/tests/instrumentation
+//
+// Exits with 1 and prints what failed.
+
+#include <cctype>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "ECM.h"
+#include "Instrumentation.h"
+#include "NumberTheory.h"
+#include "check.h"
+
+using test::check;
+
+#ifndef BIGINT_INSTRUMENTATION
+#error "the instrumentation test needs BIGINT_INSTRUMENTATION"
+#endif
+
+// recursive descent over the JSON grammar, without escapes in strings, which to_JSON does not write
+class JSONParser {
+    const std::string &text;
+    size_t i = 0;
+
+    void skip_spaces() {
+        while (i < text.size() && std::isspace((unsigned char) text[i]))
+            ++i;
+    }
+
+    bool accept(char c) {
+        skip_spaces();
+        if (i < text.size() && text[i] == c) {
+            ++i;
+            return true;
+        }
+        return false;
+    }
+
+    bool string() {
+        if (!accept('"'))
+            return false;
+        while (i < text.size() && text[i] != '"' && text[i] != '\\' && (unsigned char) text[i] >= 0x20)
+            ++i;
+        return accept('"');
+    }
+
+    bool number() {
+        skip_spaces();
+        size_t start = i;
+        if (i < text.size() && text[i] == '-')
+            ++i;
+        size_t digits = i;
+        while (i < text.size() && std::isdigit((unsigned char) text[i]))
+            ++i;
+        if (i == digits || (text[digits] == '0' && i > digits + 1))
+            return false;
+        if (i < text.size() && text[i] == '.') {
+            size_t fraction = ++i;
+            while (i < text.size() && std::isdigit((unsigned char) text[i]))
+                ++i;
+            if (i == fraction)
+                return false;
+        }
+        return i > start;
+    }
+
+    bool value() {
+        skip_spaces();
+        if (i >= text.size())
+            return false;
+        if (text[i] == '{') {
+            ++i;
+            if (accept('}'))
+                return true;
+            do
+                if (!string() || !accept(':') || !value())
+                    return false;
+            while (accept(','));
+            return accept('}');
+        }
+        if (text[i] == '[') {
+            ++i;
+            if (accept(']'))
+                return true;
+            do
+                if (!value())
+                    return false;
+            while (accept(','));
+            return accept(']');
+        }
+        return text[i] == '"' ? string() : number();
+    }
+
+public:
+    explicit JSONParser(const std::string &text) : text(text) {}
+
+    bool valid() {
+        bool ok = value();
+        skip_spaces();
+        return ok && i == text.size();
+    }
+};
+
+static bool is_metric_name(const std::string &name) {
+    if (name.empty() || std::isdigit((unsigned char) name[0]))
+        return false;
+    for (char c : name)
+        if (!std::isalnum((unsigned char) c) && c != '_' && c != ':')
+            return false;
+    return true;
+}
+
+// HELP and TYPE comments before the samples of every metric, samples as name{label="value"} number
+static bool valid_Prometheus(const std::string &text) {
+    std::istringstream lines(text);
+    std::string line, typed;
+    while (std::getline(lines, line)) {
+        if (line.rfind("# HELP ", 0) == 0) {
+            std::string name = line.substr(7, line.find(' ', 7) - 7);
+            if (!is_metric_name(name))
+                return false;
+            continue;
+        }
+        if (line.rfind("# TYPE ", 0) == 0) {
+            std::istringstream words(line.substr(7));
+            std::string type;
+            words >> typed >> type;
+            if (!is_metric_name(typed) || type != "counter")
+                return false;
+            continue;
+        }
+
+        size_t brace = line.find('{'), close = line.find("} ");
+        if (brace == std::string::npos || close == std::string::npos || line.substr(0, brace) != typed)
+            return false;
+        std::string label = line.substr(brace + 1, close - brace - 1);
+        size_t equals = label.find("=\"");
+        if (equals == std::string::npos || !is_metric_name(label.substr(0, equals)) || label.back() != '"' ||
+            label.find('"', equals + 2) != label.size() - 1)
+            return false;
+        std::string number = line.substr(close + 2);
+        char *end;
+        std::strtod(number.c_str(), &end);
+        if (number.empty() || *end != '\0')
+            return false;
+    }
+    return true;
+}
+
+static uint64_t timer_calls(const InstrumentationSnapshot &snapshot, const std::string &name) {
+    for (auto &timer : snapshot.timers)
+        if (timer.name == name)
+            return timer.calls;
+    return 0;
+}
+
+int main() {
+    set_factorization_threads(1);
+
+    // word gcds take the fast path, the count is by the longer operand
+    reset_instrumentation();
+    for (long long i = 1; i <= 100; ++i)
+        gcd(BigInt(i * 6), BigInt(i * 4 + 2));
+    BigInt long_number = (BigInt(1) << 1000) + 15;
+    gcd(long_number, BigInt(35));
+    auto snapshot = get_instrumentation_snapshot();
+    check(snapshot.total(GCD_CALLS) == 101, "gcd_calls", (long long) snapshot.total(GCD_CALLS));
+    check(snapshot.counters[GCD_CALLS][get_size_class(1)] == 100, "gcd_calls of words");
+    check(snapshot.counters[GCD_CALLS][get_size_class(16)] == 1, "gcd_calls of 16 limbs");
+    check(timer_calls(snapshot, "gcd") == 101, "gcd timer", (long long) timer_calls(snapshot, "gcd"));
+
+    // every counter moves
+    reset_instrumentation();
+    BigInt a = (BigInt(1) << 700) + 12345, b = (BigInt(1) << 300) + 999;
+    BigInt product = a * b, quotient = a / b;
+    big_pow_modulo(3, a, (BigInt(1) << 521) - 1);
+    is_prime(BigInt("1000000000000000003"));
+    get_divider_PollardRho(BigInt("1000000016000000063"));
+    ECMParameters parameters;
+    parameters.b1 = 2000;
+    parameters.curves = 2;
+    get_divider_ECM(BigInt("1000000016000000063"), parameters);
+    snapshot = get_instrumentation_snapshot();
+    for (unsigned i = 0; i < INSTRUMENTED_COUNTERS; ++i)
+        check(snapshot.total((InstrumentedCounter) i) > 0, get_counter_name((InstrumentedCounter) i));
+    check(timer_calls(snapshot, "is_prime") >= 1, "is_prime timer");
+
+    // the counts of a thread that ended go to the totals
+    reset_instrumentation();
+    std::thread([] { gcd(BigInt(12), BigInt(18)); }).join();
+    check(get_instrumentation_snapshot().total(GCD_CALLS) == 1, "gcd_calls of an ended thread");
+
+    // the exports of a snapshot with counts and timers, and of an empty one
+    snapshot = get_instrumentation_snapshot();
+    for (int pass = 0; pass < 2; ++pass) {
+        std::string json = to_JSON(snapshot), prometheus = to_Prometheus(snapshot);
+        check(JSONParser(json).valid(), "to_JSON is well formed");
+        check(valid_Prometheus(prometheus), "to_Prometheus is well formed");
+        if (pass == 0) {
+            check(json.find("\"gcd_calls\": {\"total\": 1,") != std::string::npos, "to_JSON gcd_calls");
+            check(prometheus.find("bigint_gcd_calls_total{size_class=\"1\"} 1\n") != std::string::npos,
+                  "to_Prometheus gcd_calls");
+            check(prometheus.find("bigint_calls_total{function=\"gcd\"} 1\n") != std::string::npos,
+                  "to_Prometheus gcd timer");
+        }
+        if (!JSONParser(json).valid() || !valid_Prometheus(prometheus))
+            std::printf("%s\n%s\n", json.c_str(), prometheus.c_str());
+
+        reset_instrumentation();
+        snapshot = get_instrumentation_snapshot();
+        check(snapshot.timers.empty() && snapshot.total(GCD_CALLS) == 0, "reset_instrumentation");
+    }
+
+    return test::finish();
+}
@@ -0,0 +1,64 @@
+// big_pow_modulo against ModContext::pow for exponents around every window width of the sliding window, up to past
+// 2000 bits where the window is 7 bits wide. Odd moduli of one to four limbs go through FixedMontgomery<64>, <128> and
+// <256>, the longer ones and the even ones through ModContext itself and are compared with a plain square and multiply.
+// The Montgomery ladder is checked against the sliding window, with moduli of all-ones limbs for the carries of REDC.
+//
+//   build/tests/powers [seed]
+//
+// Exits with 1 and prints the failing operands if any result differs.
+
+#include "ModContext.h"
+#include "NumberTheory.h"
+#include "check.h"
+
+using test::check;
+
+// left to right square and multiply with a reduction after every step
+static BigInt plain_pow_modulo(const BigInt &a, const BigInt &p, const BigInt &m) {
+    BigInt b = 1;
+    for (size_t i = bit_length(p.get_limbs().data(), p.get_limbs().size()); i-- > 0;) {
+        b = b * b % m;
+        if (get_bits(p.get_limbs().data(), p.get_limbs().size(), i, 1))
+            b = b * a % m;
+    }
+    return b;
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+
+    const size_t exponent_bits[] = {1, 7, 8, 25, 26, 81, 82, 241, 242, 673, 674, 1793, 1794, 2001, 4100};
+    const size_t modulus_bits[] = {17, 64, 100, 128, 190, 256, 300};
+    for (size_t bits : modulus_bits)
+        for (int odd = 0; odd < 2; ++odd) {
+            BigInt m = test::random_odd(bits) - (odd ? 0 : 1);
+            ModContext context(m);
+            for (size_t e : exponent_bits) {
+                BigInt a = test::random_bits(bits + 10), p = test::random_odd(e);
+                BigInt expected = context.pow(context.convert(a), p).to_BigInt();
+                check(big_pow_modulo(a, p, m) == expected, "big_pow_modulo", a % m, p);
+                if (e <= 1800)
+                    check(plain_pow_modulo(a % m, p, m) == expected, "ModContext::pow", a % m, p);
+            }
+        }
+
+    // the Montgomery ladder, also for moduli of all-ones limbs whose reductions carry through the whole upper half
+    for (size_t bits : {64, 128, 192, 1024, 4096}) {
+        BigInt moduli[] = {test::random_odd(bits), (BigInt(1) << (int) bits) - 1, (BigInt(1) << (int) bits) - 159};
+        for (auto &m : moduli) {
+            ModContext context(m);
+            for (BigInt a : {BigInt(1), m - 1, m - 2, test::random_bits(bits)}) {
+                BigInt p = test::random_bits(bits < 1024 ? 300 : 64);
+                BigInt expected = context.pow(context.convert(a), p).to_BigInt();
+                check(big_pow_modulo_constant_time(a, p, m) == expected, "big_pow_modulo_constant_time", a, p);
+            }
+        }
+    }
+
+    // the case that overflowed the table of odd powers of FixedMontgomery<128>
+    BigInt m = (BigInt(1) << 128) - 159, p = (BigInt(1) << 2000) + 12345;
+    ModContext context(m);
+    check(big_pow_modulo(3, p, m) == context.pow(context.convert(3), p).to_BigInt(), "3^(2^2000 + 12345)", m, p);
+
+    return test::finish();
+}
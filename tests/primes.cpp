@@ -0,0 +1,132 @@
+// The primes of Primes.h against a plain sieve of Eratosthenes: PrimeIterator from starts on and off the wheel and
+// across its segment boundaries, near 2^40 as well, prime_pi and nth_prime on both sides of the bootstrap table and of
+// MAX_PRIME_TABLE_LIMIT and at the known pi(10^k), and find_small_divider over random ranges of random products.
+//
+//   build/tests/primes [seed]
+//
+// Exits with 1 and prints the first place where a prime is wrong or missing.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "NumberTheory.h"
+#include "Primes.h"
+#include "check.h"
+
+using test::check;
+
+// the numbers a PrimeIterator segment spans
+static const uint64_t SPAN = 30 * 32768;
+
+// every prime in [low, high), crossing off the multiples of every prime up to the square root
+static std::vector<uint64_t> reference_primes(uint64_t low, uint64_t high) {
+    uint64_t root = 1;
+    while (root * root < high)
+        ++root;
+    std::vector<bool> composite_root(root + 1), composite(high - low);
+    for (uint64_t p = 2; p <= root; ++p)
+        if (!composite_root[p]) {
+            for (uint64_t m = p * p; m <= root; m += p)
+                composite_root[m] = true;
+            for (uint64_t m = std::max(p * p, (low + p - 1) / p * p); m < high; m += p)
+                composite[m - low] = true;
+        }
+
+    std::vector<uint64_t> primes;
+    for (uint64_t n = std::max<uint64_t>(low, 2); n < high; ++n)
+        if (!composite[n - low])
+            primes.push_back(n);
+    return primes;
+}
+
+// PrimeIterator(start) against the reference over count numbers
+static void check_iterator(uint64_t start, uint64_t count) {
+    auto expected = reference_primes(start, start + count);
+    PrimeIterator it(start);
+    uint64_t wrong = 0;
+    for (uint64_t p : expected)
+        if (uint64_t q = it.next(); q != p && wrong == 0)
+            wrong = p;
+    check(wrong == 0, "PrimeIterator", (long long) start, (long long) wrong);
+    check(it.next() >= start + count, "PrimeIterator past the range", (long long) start);
+}
+
+static void check_small_divider(const std::vector<uint64_t> &primes) {
+    for (int i = 0; i < 300; ++i) {
+        BigInt n = 1;
+        for (int factors = test::rng() % 6; factors > 0; --factors)
+            n *= (long long) primes[test::rng() % (i % 2 ? 200 : primes.size())];
+        if (i % 3 == 0)
+            n *= test::random_odd(200);
+        uint64_t from = test::rng() % 3000, to = from + test::rng() % (i % 2 ? 3000 : 3000000);
+
+        uint64_t expected = 0;
+        for (auto p = std::lower_bound(primes.begin(), primes.end(), from); p != primes.end() && *p <= to; ++p)
+            if (n % (long long) *p == 0) {
+                expected = *p;
+                break;
+            }
+        check(find_small_divider(n, from, to) == expected, "find_small_divider", n, (long long) to);
+    }
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+    auto primes = reference_primes(0, 3 * SPAN);
+
+    // the first segment from every start on and off the wheel, then across the first two boundaries
+    for (uint64_t start = 0; start <= 61; ++start)
+        check_iterator(start, 1000);
+    for (uint64_t start : {SPAN - 1000, SPAN + 29, (uint64_t) 65550 - 7})
+        check_iterator(start, SPAN + 2000);
+    for (int i = 0; i < 3; ++i)
+        check_iterator(test::rng() % (1ULL << 40), SPAN + 30);
+
+    // around the end of the bootstrap table, inside the full table and across its end
+    for (uint64_t x = 0; x < 100; ++x)
+        check(prime_pi(x) == (uint64_t) (std::upper_bound(primes.begin(), primes.end(), x) - primes.begin()),
+              "prime_pi", (long long) x);
+    for (int i = 0; i < 300; ++i) {
+        uint64_t x = i < 100 ? 65550 - 50 + i : test::rng() % primes.back();
+        check(prime_pi(x) == (uint64_t) (std::upper_bound(primes.begin(), primes.end(), x) - primes.begin()),
+              "prime_pi", (long long) x);
+    }
+    for (size_t n = 1; n < primes.size(); n += test::rng() % 997 + 1)
+        check(nth_prime(n) == primes[n - 1], "nth_prime", (long long) n);
+
+    uint64_t limit = MAX_PRIME_TABLE_LIMIT;
+    auto near_limit = reference_primes(limit - 3000, limit + 3000);
+    uint64_t pi_below = 3957809 - (std::upper_bound(near_limit.begin(), near_limit.end(), limit) - near_limit.begin());
+    for (size_t i = 0; i < near_limit.size(); ++i) {
+        check(prime_pi(near_limit[i]) == pi_below + i + 1 && prime_pi(near_limit[i] - 1) == pi_below + i,
+              "prime_pi near MAX_PRIME_TABLE_LIMIT", (long long) near_limit[i]);
+        check(nth_prime(pi_below + i + 1) == near_limit[i], "nth_prime near MAX_PRIME_TABLE_LIMIT",
+              (long long) (pi_below + i + 1));
+    }
+    check_iterator(limit - 1000, 2000);
+
+    // pi(10^k) and the last prime below 10^8
+    const uint64_t pi[] = {0, 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534};
+    uint64_t power = 1;
+    for (uint64_t k = 1; k < std::size(pi); ++k) {
+        power *= 10;
+        check(prime_pi(power) == pi[k], "pi(10^k)", (long long) k);
+    }
+    check(nth_prime(1) == 2 && nth_prime(5761455) == 99999989, "nth_prime");
+    bool thrown = false;
+    try {
+        nth_prime(0);
+    } catch (const char *e) {
+        thrown = std::string(e) == "PrimeIndexIsZero";
+    }
+    check(thrown, "nth_prime(0)");
+
+    check_small_divider(primes);
+    // a divider past MAX_PRIME_TABLE_LIMIT, which the iterator finds
+    BigInt n = BigInt((long long) near_limit.back()) * (long long) near_limit.back() << 70;
+    check(find_small_divider(n, limit - 3000, limit + 3000) == near_limit.back(),
+          "find_small_divider beyond the table", n);
+    check(find_small_divider(BigInt(1) << 100, 3, limit + 1000) == 0, "find_small_divider without a divider");
+
+    return test::finish();
+}
@@ -0,0 +1,148 @@
+// The binary stream format: values of every size and sign through BigIntWriter and BigIntReader and through a saved
+// and mapped BigIntArray, and every way a stream can be corrupt, which must throw instead of reading garbage.
+//
+//   build/tests/serialization [seed]
+//
+// Exits with 1 and prints the value or the case that failed.
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Serialization.h"
+#include "check.h"
+
+using test::check;
+
+static std::vector<BigInt> random_values() {
+    std::vector<BigInt> values = {0, 1, -1, BigInt(1) << 64, -(BigInt(1) << 64) + 1, (BigInt(1) << 128) - 1};
+    for (size_t bits : {1, 63, 64, 65, 200, 1000, 10000, 64 * (1 << 16) + 77}) {
+        BigInt a = test::random_bits(bits);
+        values.push_back(a);
+        values.push_back(0 - a);
+    }
+    return values;
+}
+
+static std::string word(uint64_t x) {
+    return std::string(reinterpret_cast<const char *>(&x), sizeof x);
+}
+
+// a stream with the header and the given words, read with read_record after the header
+static std::string stream_of(const std::vector<uint64_t> &words) {
+    std::string text = word(0x0053544E49474942) + word(FORMAT_VERSION);
+    for (uint64_t x : words)
+        text += word(x);
+    return text;
+}
+
+static bool throws_corrupt(const std::string &text) {
+    std::istringstream in(text);
+    try {
+        BigIntReader reader(in);
+        BigInt a;
+        while (reader.read(a)) {
+        }
+    } catch (const char *e) {
+        return std::string(e) == "CorruptBigIntStream";
+    }
+    return false;
+}
+
+static bool mapping_throws(const std::string &path, const std::string &text, const char *error) {
+    std::ofstream(path, std::ios::binary) << text;
+    try {
+        BigIntArray::map_file(path);
+    } catch (const char *e) {
+        return std::string(e) == error;
+    }
+    return false;
+}
+
+static bool mapping_throws_missing(const std::string &path) {
+    try {
+        BigIntArray::map_file(path);
+    } catch (const char *e) {
+        return std::string(e) == "CannotOpenFile";
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+    auto values = random_values();
+
+    // a stream, read back in order, then the end
+    std::stringstream stream;
+    {
+        BigIntWriter writer(stream);
+        for (auto &a : values)
+            writer.write(a);
+    }
+    BigIntReader reader(stream);
+    BigInt a;
+    for (auto &expected : values)
+        check(reader.read(a) && a == expected, "BigIntReader", expected);
+    check(!reader.read(a), "end of the stream");
+
+    // an array saved to a file and mapped back
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("bigint_serialization_" + std::to_string(test::rng()) + ".bin")).string();
+    BigIntArray array;
+    for (auto &value : values)
+        array.push_back(value);
+    array.save(path);
+    {
+        BigIntArray mapped = BigIntArray::map_file(path);
+        check(mapped.size() == values.size(), "size of the mapped array", (long long) mapped.size());
+        for (size_t i = 0; i < values.size() && i < mapped.size(); ++i)
+            check(mapped[i].to_BigInt() == values[i] && mapped[i].sign == values[i].get_sign(), "mapped value",
+                  values[i]);
+        bool read_only = false;
+        try {
+            mapped.push_back(1);
+        } catch (const char *e) {
+            read_only = std::string(e) == "ReadOnlyArray";
+        }
+        check(read_only, "a mapped array is read-only");
+
+        // the file is a stream as well
+        std::ifstream file(path, std::ios::binary);
+        BigIntReader file_reader(file);
+        for (auto &expected : values)
+            check(file_reader.read(a) && a == expected, "BigIntReader of a saved array", expected);
+    }
+
+    // corrupt records: truncated, a length far beyond the stream, a top limb of zero, a negative zero
+    check(throws_corrupt(stream_of({3 * 2, 1, 2})), "truncated record");
+    check(throws_corrupt(stream_of({~(uint64_t) 0 - 1, 5})), "length near 2^64");
+    check(throws_corrupt(stream_of({~(uint64_t) 0, 5})), "odd length near 2^64");
+    check(throws_corrupt(stream_of({(uint64_t) 1 << 40, 5})), "length of 2^39 limbs");
+    check(throws_corrupt(stream_of({2 * 2, 5, 0})), "top limb zero");
+    check(throws_corrupt(stream_of({1})), "header 1");
+    check(throws_corrupt(stream_of({2, 7}) + "abc"), "partial length word");
+    check(!throws_corrupt(stream_of({2, 7, 3, 9, 0})), "valid records");
+
+    bool unsupported = false;
+    try {
+        std::istringstream in(word(1) + word(FORMAT_VERSION));
+        BigIntReader bad(in);
+    } catch (const char *e) {
+        unsupported = std::string(e) == "UnsupportedBigIntStream";
+    }
+    check(unsupported, "bad magic");
+
+    // the same records in a mapped file
+    check(mapping_throws(path, stream_of({3 * 2, 1, 2}), "CorruptBigIntStream"), "mapped truncated record");
+    check(mapping_throws(path, stream_of({~(uint64_t) 0 - 1, 5}), "CorruptBigIntStream"), "mapped huge length");
+    check(mapping_throws(path, stream_of({2 * 2, 5, 0}), "CorruptBigIntStream"), "mapped top limb zero");
+    check(mapping_throws(path, stream_of({1}), "CorruptBigIntStream"), "mapped header 1");
+    check(mapping_throws(path, stream_of({}) + "abc", "UnsupportedBigIntStream"), "mapped partial word");
+    check(mapping_throws(path, word(FORMAT_VERSION) + word(FORMAT_VERSION), "UnsupportedBigIntStream"),
+          "mapped bad magic");
+    std::filesystem::remove(path);
+    check(mapping_throws_missing(path), "map_file of a missing file");
+
+    return test::finish();
+}
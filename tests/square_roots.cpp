@@ -0,0 +1,119 @@
+// Modular square roots: every root list of SquareRootContext against exhaustive search, for every b modulo every m up
+// to 300 and for random b modulo larger prime powers and composites, and every returned root squared for primes that
+// take each method: p = 3 (mod 4), Atkin for p = 5 (mod 8), Tonelli-Shanks, and Cipolla for a long power of 2 in p - 1.
+//
+//   build/tests/square_roots [seed]
+//
+// Exits with 1 and prints the failing b and m if any root is wrong or missing.
+
+#include <vector>
+#include "NumberTheory.h"
+#include "SquareRoot.h"
+#include "check.h"
+
+using test::check;
+
+// every x in [0, m) with x^2 = b (mod m), increasing
+static std::vector<BigInt> exhaustive_roots(long long b, long long m) {
+    std::vector<BigInt> roots;
+    for (long long x = 0; x < m; ++x)
+        if ((x * x - b) % m == 0)
+            roots.push_back(x);
+    return roots;
+}
+
+static void check_exhaustively(const SquareRootContext &context, long long b) {
+    long long m = context.get_modulus().get_limbs().empty() ? 0 : (long long) context.get_modulus().get_limbs()[0];
+    auto expected = exhaustive_roots(b, m);
+    check(context.roots(b) == expected, "roots", b, m);
+
+    BigInt x = context.root(b);
+    check(expected.empty() ? x == -1 : x >= 0 && x < m && (x * x - b) % m == 0, "root", b, m);
+}
+
+// roots modulo a large m only by squaring them: x is among the roots of x^2, which are count many for x coprime to m
+static void check_by_squaring(const BigInt &m, const BigInt &x, size_t count) {
+    SquareRootContext context(m);
+    BigInt b = x * x % m;
+    auto roots = context.roots(b);
+    bool ok = gcd(x, m) != 1 || roots.size() == count, found = false;
+    for (auto &r : roots) {
+        ok = ok && r >= 0 && r < m && (r * r - b) % m == 0;
+        found = found || r == x;
+    }
+    check(ok && found, "roots of a square", b, m);
+
+    BigInt root = discrete_sqrt(b, m);
+    check(root >= 0 && (root * root - b) % m == 0, "discrete_sqrt", b, m);
+}
+
+int main(int argc, char **argv) {
+    test::seed(argc, argv);
+
+    // every b for m up to 300, with p = 2 and odd prime powers, and composites
+    for (long long m = 1; m <= 300; ++m) {
+        SquareRootContext context(m);
+        for (long long b = 0; b < m; ++b)
+            check_exhaustively(context, b);
+        check_exhaustively(context, m + 7);
+    }
+
+    // random b, squares and squares times prime powers, modulo larger prime powers and composites
+    const long long moduli[] = {4096, 6561, 15625, 16807, 2 * 2 * 2 * 3 * 3 * 5 * 7 * 11, 9 * 25 * 49, 4 * 17 * 19,
+                                1 << 15, 13 * 13 * 13 * 4};
+    for (long long m : moduli) {
+        SquareRootContext context(m);
+        for (int i = 0; i < 40; ++i) {
+            long long x = test::rng() % m, b = i % 3 == 0 ? test::rng() % m : i % 3 == 1 ? x * x % m : x * x * 8 % m;
+            check_exhaustively(context, b);
+        }
+    }
+
+    // primes of every method, with p - 1 = odd 2^s: 3 (mod 4), 5 (mod 8), Tonelli-Shanks with s = 3, 8 and 13,
+    // Cipolla with s = 13 for a 16-bit p, s = 16 and 32
+    const char *primes[] = {"1000000007", "1000000021", "1000000009", "257", "1073750017", "40961", "65537",
+                            "18446744069414584321", "170141183460469231731687303715884105727"};
+    for (const char *text : primes) {
+        BigInt p(text);
+        SquareRootContext context(p);
+        for (int i = 0; i < 20; ++i) {
+            BigInt x = test::random_bits(140) % p, b = x * x % p;
+            auto roots = context.roots(b);
+            check(roots.size() == (b == 0 ? 1u : 2u), "number of roots modulo a prime", b, p);
+            for (auto &r : roots)
+                check((r * r - b) % p == 0, "root modulo a prime", b, p);
+
+            BigInt non_residue = test::random_bits(140) % p;
+            if (Legendre_symbol(non_residue, p, true) == -1)
+                check(context.root(non_residue) == -1 && context.roots(non_residue).empty(), "non-residue",
+                      non_residue, p);
+        }
+    }
+
+    // Hensel lifting to high powers and roots modulo products of large primes, 2 roots of a unit modulo an odd prime
+    // power, 4 modulo 2^k for k >= 3 and 2 modulo 4
+    const struct {
+        BigInt m;
+        size_t count;
+    } large_moduli[] = {
+        {BigInt(1000000007) * 1000000007 * 1000000007, 2},
+        {BigInt(1) << 100, 4},
+        {BigInt("18446744069414584321") * BigInt("1000000009") * 65537 * 4, 16},
+        {big_pow(3, 12) * BigInt("1000000021"), 4},
+    };
+    for (auto &[m, count] : large_moduli)
+        for (int i = 0; i < 10; ++i)
+            check_by_squaring(m, test::random_bits(250) % m, count);
+
+    // a batch gives the roots of one context, -1 for non-residues
+    BigInt m("1000000009");
+    std::vector<BigInt> b;
+    for (long long i = 0; i < 2000; ++i)
+        b.push_back(i * i * 7 + i);
+    auto batch = discrete_sqrt_batch(b, m);
+    for (size_t i = 0; i < b.size(); ++i)
+        check(batch[i] == -1 ? Legendre_symbol(b[i], m, true) == -1 : (batch[i] * batch[i] - b[i]) % m == 0,
+              "discrete_sqrt_batch", b[i], m);
+
+    return test::finish();
+}